@@ -59,6 +59,7 @@
             'libraries':
             [
                 " <!@(sdl2-config --libs)", #-lGL
+                "-lrt", #shm_open() on older glibc
 #                " -L'<!(pwd)'",
 #                "<(module_root_dir)/build/Release/",
             ],
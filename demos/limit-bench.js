@@ -0,0 +1,50 @@
+#!/usr/bin/env node
+//microbenchmark: brightness limit for 1 univ of colors at a time
+//compares gp.limitArray() vs. gp.limit() per color vs. pure JS
+//to run: node demos/limit-bench.js [#univ] [#reps]
+
+'use strict'; //find bugs easier
+require('colors').enabled = true; //for console output colors
+const gp = require("../build/Release/gpuport");
+const {NUM_UNIV, UNIV_MAXLEN} = gp;
+
+const NUMUNIV = +process.argv[2] || NUM_UNIV; //#univ per frame
+const REPS = +process.argv[3] || 100; //#frames
+const BRIGHTEST = Math.floor(3 * 255 * gp.MAX_BRIGHT / 100); //max R+G+B; same as C++ limit<> default
+
+//pure JS version of limit<>:
+function limit_js(color)
+{
+    const r = (color >> 16) & 0xFF, g = (color >> 8) & 0xFF, b = color & 0xFF;
+    const sum = r + g + b;
+    if (sum <= BRIGHTEST) return color;
+    const half = sum >> 1; //rdiv() rounding
+    return ((((r * BRIGHTEST + half) / sum) << 16) | (((g * BRIGHTEST + half) / sum) << 8) | (((b * BRIGHTEST + half) / sum) | 0)) >>> 0; //"<<" and "|" truncate like int divide
+}
+
+//mostly bright colors so limit actually has work to do:
+const src = new Uint32Array(UNIV_MAXLEN);
+for (let i = 0; i < src.length; ++i) src[i] = (0xFF000000 | (Math.random() * 0x1000000)) >>> 0;
+const nodes = new Uint32Array(src.length);
+
+const tests =
+{
+    limitArray: () => { nodes.set(src); gp.limitArray(nodes); },
+    "limit() per color": () => { for (let i = 0; i < src.length; ++i) nodes[i] = gp.limit(src[i]); },
+    "pure JS": () => { for (let i = 0; i < src.length; ++i) nodes[i] = limit_js(src[i]); },
+};
+
+const results = {};
+for (const [name, test] of Object.entries(tests))
+{
+    for (let u = 0; u < NUMUNIV; ++u) test(); //warm up JIT
+    const started = process.hrtime();
+    for (let rep = 0; rep < REPS; ++rep)
+        for (let u = 0; u < NUMUNIV; ++u) test();
+    const [sec, nsec] = process.hrtime(started);
+    const msec = (sec * 1e3 + nsec / 1e6) / REPS;
+    results[name] = nodes.slice(0, 8).join(",");
+    console.log(`${name}: ${msec.toFixed(3)} msec/frame (${NUMUNIV} x ${UNIV_MAXLEN} nodes), ${(msec * 1e6 / (NUMUNIV * UNIV_MAXLEN)).toFixed(1)} nsec/node`.cyan);
+}
+const agree = new Set(Object.values(results)).size == 1; //all 3 should give identical colors
+console.log(agree? "results match".green: "results differ".red);
@@ -0,0 +1,40 @@
+#!/usr/bin/env node
+//startup benchmark: module load time + heap per proc/thread
+//compares plain require() (nodes[] typed arrays created lazily) vs. require() + touching every nodebufs[].nodes (what eager init used to cost)
+//each sample runs in a fresh proc so module caches don't skew results
+//to run: node demos/startup-bench.js [#samples]
+
+'use strict'; //find bugs easier
+require('colors').enabled = true; //for console output colors
+const {execFileSync} = require("child_process");
+const pathlib = require("path");
+
+const SAMPLES = +process.argv[2] || 10;
+const ADDON = pathlib.resolve(__dirname, "../build/Release/gpuport");
+
+//run in child proc; prints load time (msec) and heap/external growth (KB):
+function sample(touch)
+{
+    const script = `
+        if (global.gc) gc();
+        const before = process.memoryUsage(), started = process.hrtime();
+        const gp = require(${JSON.stringify(ADDON)});
+        if (${touch}) for (const nodebuf of gp.nodebufs) for (const univ of nodebuf.nodes) univ.length;
+        const elapsed = process.hrtime(started);
+        if (global.gc) gc();
+        const after = process.memoryUsage();
+        console.log(JSON.stringify({msec: elapsed[0] * 1e3 + elapsed[1] / 1e6, heapKB: (after.heapUsed - before.heapUsed) / 1024}));`;
+    return JSON.parse(execFileSync(process.execPath, ["--expose-gc", "-e", script], {encoding: "utf8"}).split("\n").filter((line) => line.startsWith("{")).pop());
+}
+
+for (const [name, touch] of [["lazy (require only)", false], ["all nodes touched", true]])
+{
+    let msec = 0, heapKB = 0;
+    for (let i = 0; i < SAMPLES; ++i)
+    {
+        const {msec: t, heapKB: h} = sample(touch);
+        msec += t; heapKB += h;
+    }
+    console.log(`${name}: ${(msec / SAMPLES).toFixed(2)} msec, heap +${(heapKB / SAMPLES).toFixed(0)} KB (avg of ${SAMPLES})`.cyan);
+}
+//eof
@@ -82,11 +82,28 @@
 #include <string> //std::string
 #include <map> //std::map<>
 #include <limits.h> //INT_MAX
+#include <sched.h> //SCHED_FIFO, SCHED_RR, cpu_set_t
+#include <pthread.h> //pthread_setschedparam(), pthread_setaffinity_np()
+#include <sys/mman.h> //mlockall()
+#include <unistd.h> //fork(), setsid(), pipe()
+#include <sys/wait.h> //waitpid()
+#include <signal.h> //kill(), signal()
+#include <fcntl.h> //O_CLOEXEC
+#include <dlfcn.h> //dladdr()
 #include <bitset> //std::bitset<>
+#include <mutex> //std::mutex, std::unique_lock<>
+#include <condition_variable> //std::condition_variable
+#include <vector> //std::vector<>
+#include <sys/syscall.h> //SYS_futex
+#include <linux/futex.h> //FUTEX_WAIT, FUTEX_WAKE
+#include <chrono> //std::chrono::steady_clock
+#include <thread> //std::thread
+#include <deque> //std::deque<>
+#include <memory> //std::shared_ptr<>
 
 #define MAX_DEBUG_LEVEL  100 //set this before debug() is included via nested #includes
 #include "str-helpers.h" //unmap(), NNNN_hex(), vector_cxx17<>
-//#include "thr-helpers.h" //thrinx()
+#include "thr-helpers.h" //BkgSync<>
 //can't get rid of flicker; use framebuf instead:
 #if 0
  #include "sdl-helpers.h" //AutoTexture, Uint32, elapsed(), now()
@@ -102,6 +119,8 @@
 //#include "ostrfmt.h" //FMT()
 #include "logging.h"
 #include "rgb-helpers.h" //must come after sdl-helpers
+#include "effects.h" //Effect
+#include "pixmap.h" //PixelMap
 
 //which Node API to use?
 //V8 is older, requires more familiarity with V8
@@ -237,6 +256,7 @@ public:
 //CAUTION: don't store ptrs; they won't be valid in other procs
 //all ipc and sync occurs via this struct to allow procs/threads to run at max speed and avoid costly memory xfrs
 //#define IFDEBUG(yes_stmt, no_stmt)  no_stmt
+napi_value GpuModuleInit(napi_env env, napi_value exports); //fwd ref; daemon uses it to find addon path
 struct ShmData
 {
 //    static const bool CachedWrapper = false; //true; //BROKEN; leave turned OFF
@@ -252,6 +272,7 @@ struct ShmData
     static const int HWMUX = 0; //#I/O pins (0..23) to use for external h/w mux
 //derived settings:
     static const int NUM_UNIV = IFDEBUG(3, (1 << HWMUX) * (IOPINS - HWMUX)); //max #univ with/out external h/w mux
+    static const int MAX_PORTS = 4; //#GPU ports (screens/outputs) open at once; each has its own shm seg, gpu wker and vsync
 //settings that must match (cannot exceed) video config:
 //put 3 most important constraints first, 4th will be dependent on other 3
 //default values are for my layout
@@ -268,7 +289,12 @@ struct ShmData
     static const int NODEBITS = 24; //# bits to send for each WS281X node (protocol dependent)
     static const int BIT_SLICES = NODEBITS * 3; //divide each node data bit into 1/3s (last 1/3 of last node bit will overlap hsync)
     static const unsigned int NODEVAL_MSB = 1 << (NODEBITS - 1);
+    static inline MASK_TYPE univ_bit(int x) { return NODEVAL_MSB >> x; } //ready/late bit for univ x; univ 0 is MSB (same order as xfr_bb start bits)
     static const int BRIGHTEST = pct(50/60);
+//WS281X timing tolerances (checked against real video timing at open):
+    static constexpr double BIT_USEC_MIN = 0.975, BIT_USEC_MAX = 1.425; //T0H = 1/3 bit and T1H = 2/3 bit must be within +/-150 nsec of 0.4 and 0.8 usec
+    static constexpr double HBLANK_USEC_MAX = 1.0; //hsync + porches overlap last 1/3 of last bit, which must stay low
+    static constexpr double LATCH_USEC_MIN = 50; //vblank must be at least WS281X reset (latch) time
 //    static const unsigned int NODEVAL_MASK = 1 << NODEBITS - 1;
     static const MASK_TYPE UNIV_MASK = (1 << NUM_UNIV) - 1;
     static const MASK_TYPE ALL_UNIV = UNIV_MASK; //NODEVAL_MASK;
@@ -278,7 +304,7 @@ struct ShmData
     static const int QUELEN = IFDEBUG(2, 4); //#render queue entries (circular)
     static const int SPARELEN = IFDEBUG(6, 64);
     static const uint32_t VALIDCHK = 0xf00d1234;
-    static const int VERSION = 0x001812; //0.18.12
+    static const int VERSION = 0x001901; //0.19.1; NOTE: bump whenever shm layout changes (stale segments are rejected at attach)
 //    static const key_t SHMKEY = 0xfeed0000 | NNNN_hex(UNIV_MAXLEN_pad); //0; //show size in key; avoids recompile/rerun size conflicts and makes debug easier (ipcs -m)
 public: //dependent types:
 //data format (protocol) selector:
@@ -383,6 +409,22 @@ public: //dependent types:
         const /*size_t*/ uint32_t frctl_ofs = offsetof(ShmData, m_frctl), frctl_len = sizeof(m_frctl);
         const /*size_t*/ uint32_t spares_ofs = offsetof(ShmData, m_spare), spares_len = sizeof(m_spare);
         const /*size_t*/ uint32_t nodebufs_ofs = offsetof(ShmData, m_fbque), nodebufs_len = sizeof(m_fbque);
+//header words; JS reads these through typed array views with no native calls:
+//frctl_i32/frctl_u32 = Int32Array/Uint32Array over frctl; nodebufs[].hdr_i32/hdr_u32 = same over each nodebuf (fbquent_len bytes apart)
+//*_inx are 32-bit word indexes within those views (byte ofs / 4); all header words are 32 bits so Atomics can be used on them
+        const uint32_t numfr_inx = offsetof(FrameControl, numfr) / 4, latest_inx = offsetof(FrameControl, latest) / 4, isrunning_inx = offsetof(FrameControl, isrunning) / 4;
+        const uint32_t epoch_inx = offsetof(FrameControl, epoch) / 4, heartbeat_inx = offsetof(FrameControl, heartbeat) / 4, generation_inx = offsetof(FrameControl, generation) / 4;
+        const uint32_t numtween_inx = offsetof(FrameControl, numtween) / 4, numpartial_inx = offsetof(FrameControl, numpartial) / 4, numdrop_inx = offsetof(FrameControl, numdrop) / 4;
+        const uint32_t fbquent_len = sizeof(FramebufQuent), nodes_ofs = offsetof(FramebufQuent, nodes); //nodes follow header in each nodebuf
+        const uint32_t frnum_inx = offsetof(FramebufQuent, frnum) / 4, frtime_inx = offsetof(FramebufQuent, frtime) / 4, prevtime_inx = offsetof(FramebufQuent, prevtime) / 4;
+        const uint32_t ready_inx = offsetof(FramebufQuent, ready) / 4, target_inx = offsetof(FramebufQuent, target) / 4;
+        explicit ManifestType(int port = 0): shmkey(port_shmkey(port))
+        {
+            static_assert((sizeof(FrameControl::numfr) == 4) && (sizeof(FrameControl::latest) == 4) && (sizeof(FrameControl::isrunning) == 4) && (sizeof(FrameControl::epoch) == 4) && (sizeof(FrameControl::heartbeat) == 4), "frctl header words must be 32 bits");
+            static_assert((sizeof(FramebufQuent::frnum) == 4) && (sizeof(FramebufQuent::frtime) == 4) && (sizeof(FramebufQuent::target) == 4), "nodebuf header words must be 32 bits");
+            static_assert(sizeof(MASK_TYPE) == 4, "ready word must be 32 bits"); //futex word; BkgSync keeps it first so ready_inx addresses it
+            static_assert(!(sizeof(FramebufQuent) % 4), "nodebuf len must be multiple of 32 bits");
+        }
 //        const /*size_t*/ uint32_t msgs_ofs = offsetof(ShmData, m_msglog), msgs_len = sizeof(m_msglog);
     public: //operators
         STATIC friend std::ostream& operator<<(std::ostream& ostrm, const ManifestType& that) //dummy_shared_state) //https://stackoverflow.com/questions/2981836/how-can-i-use-cout-myclass?utm_medium=organic&utm_source=google_rich_qa&utm_campaign=google_rich_qa
@@ -395,7 +437,7 @@ public: //dependent types:
             ostrm << "{shm " << commas(that.shmlen) << ":" << std::hex << that.shmkey << std::dec;
             ostrm << ", frctl " << commas(that.frctl_len) << ":+" << commas(that.frctl_ofs);
             ostrm << ", spares " << commas(that.spares_len) << ":+" << commas(that.spares_ofs);
-            ostrm << ", nodebufs " << commas(that.nodebufs_len) << ":+" << commas(that.nodebufs_ofs);
+            ostrm << ", nodebufs " << commas(that.nodebufs_len) << ":+" << commas(that.nodebufs_ofs) << " (" << commas(that.fbquent_len) << " each, nodes +" << commas(that.nodes_ofs) << ")";
 //            ostrm << ", msgs " << commas(that.msgs_len) << ":+" << commas(that.msgs_ofs);
             return ostrm << "}";
         }
@@ -418,6 +460,22 @@ public: //dependent types:
             add_prop_uint32(spares_len)(props.emplace_back());
             add_prop_uint32(nodebufs_ofs)(props.emplace_back());
             add_prop_uint32(nodebufs_len)(props.emplace_back());
+            add_prop_uint32(numfr_inx)(props.emplace_back());
+            add_prop_uint32(latest_inx)(props.emplace_back());
+            add_prop_uint32(isrunning_inx)(props.emplace_back());
+            add_prop_uint32(epoch_inx)(props.emplace_back());
+            add_prop_uint32(heartbeat_inx)(props.emplace_back());
+            add_prop_uint32(generation_inx)(props.emplace_back());
+            add_prop_uint32(numtween_inx)(props.emplace_back());
+            add_prop_uint32(numpartial_inx)(props.emplace_back());
+            add_prop_uint32(numdrop_inx)(props.emplace_back());
+            add_prop_uint32(fbquent_len)(props.emplace_back());
+            add_prop_uint32(nodes_ofs)(props.emplace_back());
+            add_prop_uint32(frnum_inx)(props.emplace_back());
+            add_prop_uint32(frtime_inx)(props.emplace_back());
+            add_prop_uint32(prevtime_inx)(props.emplace_back());
+            add_prop_uint32(ready_inx)(props.emplace_back());
+            add_prop_uint32(target_inx)(props.emplace_back());
 //            add_prop_uint32(msgs_ofs)(props.emplace_back());
 //            add_prop_uint32(msgs_len)(props.emplace_back());
             add_prop_uint32("sizeof_float", sizeof(double))(props.emplace_back()); //for debug frame_time; NOTE: not present in shm, just JS retval
@@ -450,6 +508,44 @@ public: //dependent types:
         elapsed_t /*decltype(TXTR::latest)*/ latest = 0; //timestamp of latest loop iteration
         PreallocVector<elapsed_t, SIZEOF(TXTR::perf_stats) /*+ 1*/> perf_stats; //NO: 1 extra slot for loop count, but still want a local copy
         char exc_reason[80] = ""; //exc message if bkg gpu wker throws error
+//what to show when next frame isn't ready in time (default is stall until all univ ready):
+        enum { TWEEN_NONE = 0, TWEEN_HOLD, TWEEN_BLEND }; //NONE and HOLD both leave previous frame on screen; HOLD = NONE + numtween counting
+        int32_t tween = TWEEN_NONE;
+        int32_t numtween = 0; //#vsyncs spent waiting for a late frame (held or blended), including frames later dropped as too late; HOLD/BLEND only
+//partial frames: commit frame this many msec before vsync with whichever univ are ready; late univ repeat their previous bits (0 = wait for all univ):
+        int32_t deadline_msec = 0;
+        int32_t numpartial = 0; //#frames committed with late univ
+        uint32_t univ_late[NUM_UNIV] = {0}; //#frames each univ missed deadline; helps find slow renderer
+//wall-clock scheduling: each frame has a target time; drop frames that are too late so show stays in sync (ie, with audio):
+        int32_t catchup = false;
+        elapsed_t epoch = 0; //show start time; frame targets are relative to this
+        int32_t numdrop = 0; //#frames skipped to catch up
+        int32_t drift_msec = 0, maxdrift_msec = 0; //latest + worst (actual - target) presentation time
+//real-time tuning for gpu wker thread (less vsync misses from Node GC or other procs); best effort, outcome in rt_status:
+        int32_t rtpolicy = SCHED_OTHER;
+        int32_t rtprio = 0; //FIFO/RR priority; clamped to valid range
+        uint32_t cpumask = 0; //CPU affinity (0 = any)
+        int32_t mlock = false; //lock all process memory (avoid page faults)
+        char rt_status[80] = ""; //what was actually applied
+        char timing[96] = ""; //timing solver result
+        int32_t pipeline = false; //encode next frame on gpu wker while presenter thread waits for vsync
+//watchdog: restart gpu wker if it dies or stalls; render wkers keep going because fbque is not reinitialized:
+        int32_t watchdog = 0; //#frame times without heartbeat before restart (0 = no watchdog)
+        int32_t supervised = false; //watchdog is running
+        int32_t generation = 0; //bumped on each restart
+        elapsed_t heartbeat = 0; //updated by gpu wker every loop iteration, including while waiting for render wkers
+        int32_t numrestart = 0;
+        char restart_reason[80] = ""; //reason for latest restart or stall
+//daemon: gpu wker runs in its own proc so it outlives the Node proc that opened the port; other Node procs attach via shm key:
+        int32_t owner = 0; //pid of proc running gpu wker; used to detect stale state left by a crashed proc
+        int32_t daemon = 0; //pid of daemon proc (0 = gpu wker runs in Node proc)
+        int32_t port = 0; //which GPU port this is; univ in this port are port * NUM_UNIV + x in combined univ index
+        std::atomic<int32_t> numfr_waiters; //#threads (any proc) blocked in waitFrame(); gpu wker skips futex wake if 0
+//native render pool (startPool()); stats are written by pool threads so any proc can watch utilization:
+        enum { MAX_POOL = 8 };
+        int32_t pool_threads = 0; //#pool threads running (0 = no pool)
+        std::atomic<uint32_t> pool_tasks, pool_steals; //#univ tasks rendered, #tasks taken from another thread's queue
+        uint32_t pool_util[MAX_POOL] = {0}; //% busy for each pool thread over latest 1 sec
 #if 0
 //debug event emitters:
 //description of cvar: https://stackoverflow.com/questions/16350473/why-do-i-need-stdcondition-variable
@@ -464,7 +560,7 @@ public: //dependent types:
         static /*cb_info cbs[5]*/ PreallocVector<cb_info, 5> cbs; //doesn't need to be in shm
 #endif
     public: //ctors/dtors
-        explicit FrameControl(int new_screen, const SDL_Size& new_wh, double new_frame_time): screen(new_screen), wh(new_wh), frame_time(new_frame_time) {} // HERE(3); }
+        explicit FrameControl(int new_screen, const SDL_Size& new_wh, double new_frame_time): screen(new_screen), wh(new_wh), frame_time(new_frame_time), numfr_waiters(0), pool_tasks(0), pool_steals(0) {} // HERE(3); }
     public: //operators
         STATIC friend std::ostream& operator<<(std::ostream& ostrm, const FrameControl& that) //dummy_shared_state) //https://stackoverflow.com/questions/2981836/how-can-i-use-cout-myclass?utm_medium=organic&utm_source=google_rich_qa&utm_campaign=google_rich_qa
         {
@@ -481,17 +577,11 @@ public: //dependent types:
             ostrm << ", debug level " << /*that.*/detail(); //debug_level; //TODO: put a copy in shm
             ostrm << ", #fr " << commas(that.numfr);
             ostrm << ", latest " << that.latest << " msec";
-            ostrm << ", evt pending? " << that.signal_pending;
             ostrm << ", evth [";
-            for (auto itcb = that.cbs.begin(); itcb != that.cbs.end(); ++itcb)
+            for (int i = 0; i < NUM_EVTS; ++i)
             {
-                ostrm << &", "[(itcb == that.cbs.begin())? 2: 0] << (itcb - that.cbs.begin()) << ": ";
-                switch (itcb->state)
-                {
-                    case REPEAT: ostrm << "cb-n"; break;
-                    case ONCE: ostrm << "cb-1"; break;
-                    default: ostrm << "-"; break;
-                }
+                const Listener& lsnr = listeners(that.port)[i];
+                ostrm << &", "[i? 0: 2] << evtname(i) << ": " << (!lsnr.fats.load()? "-": lsnr.once? "cb-1": "cb-n") << (lsnr.pending.load()? "*": "");
             }
             ostrm << "], perf [";
 //            for (int i = 0; i < SIZEOF(that.perf_stats); ++i)
@@ -504,6 +594,14 @@ public: //dependent types:
 //            }
             ostrm << "]";
             if (that.exc_reason[0]) ostrm << ", exc '" << that.exc_reason << "'";
+            if (that.tween) ostrm << ", tween " << that.tween << " x " << commas(that.numtween);
+            if (that.deadline_msec) ostrm << ", deadline " << that.deadline_msec << " msec, partial x " << commas(that.numpartial);
+            if (that.rt_status[0]) ostrm << ", rt '" << that.rt_status << "'";
+            if (that.timing[0]) ostrm << ", timing '" << that.timing << "'";
+            if (that.daemon) ostrm << ", daemon pid " << that.daemon;
+            if (that.watchdog) ostrm << ", watchdog " << that.watchdog << " fr, restarts " << that.numrestart << (that.restart_reason[0]? " '": "") << that.restart_reason << (that.restart_reason[0]? "'": "");
+            if (that.pool_threads) ostrm << ", pool " << that.pool_threads << " thr, tasks " << commas(that.pool_tasks.load()) << ", steals " << commas(that.pool_steals.load());
+            if (that.catchup) ostrm << ", drift " << that.drift_msec << " (max " << that.maxdrift_msec << ") msec, dropped " << commas(that.numdrop);
             ostrm << ", age " << commas(Now() - that.started) << " msec";
             return ostrm << "}";
         }
@@ -526,7 +624,23 @@ public: //dependent types:
         static /*uint32_t*/ napi_value numfr_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->numfr, napi_thingy::Uint32{}); }
         static /*uint32_t*/ napi_value latest_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->latest, napi_thingy::Uint32{}); }
         static /*uint32_t*/ napi_value exc_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->exc_reason); }
-        static /*uint32_t*/ napi_value evt_pending_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->evt_pending); }
+        static /*uint32_t*/ napi_value numtween_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->numtween, napi_thingy::Int32{}); }
+        static /*uint32_t*/ napi_value deadline_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->deadline_msec, napi_thingy::Int32{}); }
+        static /*uint32_t*/ napi_value numpartial_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->numpartial, napi_thingy::Int32{}); }
+        static /*uint32_t*/ napi_value numrestart_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->numrestart, napi_thingy::Int32{}); }
+        static /*uint32_t*/ napi_value restart_reason_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->restart_reason); }
+        static /*uint32_t*/ napi_value owner_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->owner, napi_thingy::Int32{}); }
+        static /*uint32_t*/ napi_value daemon_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->daemon, napi_thingy::Int32{}); }
+        static /*uint32_t*/ napi_value rt_status_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->rt_status); }
+        static /*uint32_t*/ napi_value timing_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->timing); }
+        static /*uint32_t*/ napi_value epoch_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->epoch, napi_thingy::Uint32{}); }
+        static /*uint32_t*/ napi_value numdrop_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->numdrop, napi_thingy::Int32{}); }
+        static /*uint32_t*/ napi_value drift_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->drift_msec, napi_thingy::Int32{}); }
+        static /*uint32_t*/ napi_value maxdrift_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->maxdrift_msec, napi_thingy::Int32{}); }
+        static /*uint32_t*/ napi_value pool_threads_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->pool_threads, napi_thingy::Int32{}); }
+        static /*uint32_t*/ napi_value pool_tasks_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->pool_tasks.load(), napi_thingy::Uint32{}); }
+        static /*uint32_t*/ napi_value pool_steals_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->pool_steals.load(), napi_thingy::Uint32{}); }
+        static /*uint32_t*/ napi_value evt_pending_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, listeners(my(ptr)->port)[EVT_PRESENT].pending || listeners(my(ptr)->port)[EVT_FREE].pending, napi_thingy::Boolean{}); }
 //        /*static*/ napi_value my_exports(napi_env env) { return my_exports(env, napi_thingy(env, napi_thingy::Object{})); }
         /*static*/ napi_value my_exports(napi_env env, const napi_value& retval)
         {
@@ -555,15 +669,57 @@ public: //dependent types:
             add_prop("perf_stats", perf_typary)(props.emplace_back()); //(*pptr++);
 //            add_prop("perf_stats", napi_thingy(env, GPU_NODE_type, SIZEOF(perf_stats), napi_thingy(env, &perf_stats[0], sizeof(perf_stats)))(props.emplace_back()); //(*pptr++);
             add_getter("exc_reason", FrameControl::exc_getter, this)(props.emplace_back()); //(*pptr++);
+            add_getter("numtween", FrameControl::numtween_getter, this)(props.emplace_back());
+            add_getter("deadline_msec", FrameControl::deadline_getter, this)(props.emplace_back());
+            add_getter("numpartial", FrameControl::numpartial_getter, this)(props.emplace_back());
+            napi_thingy late_arybuf(env, &univ_late[0], sizeof(univ_late));
+            napi_thingy late_typary(env, napi_uint32_array, SIZEOF(univ_late), late_arybuf); //live view; JS can reset counters
+            add_prop("univ_late", late_typary)(props.emplace_back());
+            napi_thingy frctl_arybuf(env, this, sizeof(*this)); //raw header words; see manifest.*_inx
+            add_prop("frctl_i32", napi_thingy(env, napi_int32_array, sizeof(*this) / 4, frctl_arybuf))(props.emplace_back());
+            add_prop("frctl_u32", napi_thingy(env, napi_uint32_array, sizeof(*this) / 4, frctl_arybuf))(props.emplace_back());
+            add_getter("epoch", FrameControl::epoch_getter, this)(props.emplace_back());
+            add_getter("rt_status", FrameControl::rt_status_getter, this)(props.emplace_back());
+            add_getter("timing", FrameControl::timing_getter, this)(props.emplace_back());
+            add_getter("numrestart", FrameControl::numrestart_getter, this)(props.emplace_back());
+            add_getter("restart_reason", FrameControl::restart_reason_getter, this)(props.emplace_back());
+            add_getter("owner", FrameControl::owner_getter, this)(props.emplace_back());
+            add_getter("daemon", FrameControl::daemon_getter, this)(props.emplace_back());
+            add_getter("numdrop", FrameControl::numdrop_getter, this)(props.emplace_back());
+            add_getter("drift_msec", FrameControl::drift_getter, this)(props.emplace_back());
+            add_getter("maxdrift_msec", FrameControl::maxdrift_getter, this)(props.emplace_back());
+            add_getter("pool_threads", FrameControl::pool_threads_getter, this)(props.emplace_back());
+            add_getter("pool_tasks", FrameControl::pool_tasks_getter, this)(props.emplace_back());
+            add_getter("pool_steals", FrameControl::pool_steals_getter, this)(props.emplace_back());
+            napi_thingy util_arybuf(env, &pool_util[0], sizeof(pool_util));
+            add_prop("pool_util", napi_thingy(env, napi_uint32_array, SIZEOF(pool_util), util_arybuf))(props.emplace_back()); //live view, 1 entry per pool thread
             add_getter("evt_pending", FrameControl::evt_pending_getter, this)(props.emplace_back()); //(*pptr++);
 //methods:
             add_method("on", std::bind(FrameControl::On_NAPI, std::placeholders::_1, std::placeholders::_2, false), this)(props.emplace_back()); //(*pptr++);
             add_method("once", std::bind(FrameControl::On_NAPI, std::placeholders::_1, std::placeholders::_2, true), this)(props.emplace_back()); //(*pptr++);
-            add_method("emit", FrameControl::Emit_NAPI, this)(props.emplace_back()); //(*pptr++);
+            add_method("off", FrameControl::Off_NAPI, this)(props.emplace_back());
 //            retval += props;
 //            return retval;
             return napi_thingy(env, retval) += props;
         }
+        static napi_value my_exports_tween(napi_env env)
+        {
+            napi_thingy retval(env, napi_thingy::Object{});
+            vector_cxx17<my_napi_property_descriptor> props;
+            add_prop_uint32("NONE", TWEEN_NONE)(props.emplace_back());
+            add_prop_uint32("HOLD", TWEEN_HOLD)(props.emplace_back()); //same as NONE, but counted
+            add_prop_uint32("BLEND", TWEEN_BLEND)(props.emplace_back());
+            return retval += props;
+        }
+        static napi_value my_exports_sched(napi_env env)
+        {
+            napi_thingy retval(env, napi_thingy::Object{});
+            vector_cxx17<my_napi_property_descriptor> props;
+            add_prop_uint32("OTHER", SCHED_OTHER)(props.emplace_back());
+            add_prop_uint32("FIFO", SCHED_FIFO)(props.emplace_back());
+            add_prop_uint32("RR", SCHED_RR)(props.emplace_back());
+            return retval += props;
+        }
         static napi_value my_exports_perfinx(napi_env env) { return my_exports_perfinx(env, napi_thingy(env, napi_thingy::Object{})); }
         static napi_value my_exports_perfinx(napi_env env, const napi_value& retval)
         {
@@ -584,147 +740,261 @@ public: //dependent types:
 //            return more_retval;
             return napi_thingy(env, retval) += props;
         }
-//(add) debug evt handlers:
-        static napi_value On_NAPI(napi_env env, napi_callback_info info, bool once)
+//frame evt handlers:
+//gpu wker can't call JS directly, so it uses a thread-safe function; calls are non-blocking and coalesced (at most 1 pending per evt)
+//JS cb gets latest info when it runs, so a slow event loop sees fewer events rather than a growing backlog
+//NOTE: fats can't be shared across procs, so listeners are process-local (not in shm) and only see gpu wker started by this proc
+//within a proc, the last env (main thread or worker_thread) to call on() for an evt gets it
+        enum { EVT_PRESENT = 0, EVT_FREE, NUM_EVTS };
+        struct Listener
         {
-            if (!env) return NULL; //Node cleanup mode?
-            DebugInOut("On_napi");
-
-            ShmData* shmptr;
-            napi_value argv[2+1], This; //allow 1 extra arg to check for extras
-            size_t argc = SIZEOF(argv);
-//    !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, NULL, NULL), "Arg parse failed");
-            !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
-            if (argc) NAPI_exc("expected 2 args, got " << argc << " arg" << plural(argc));
-            shmptr->isvalid(env, SRCLINE);
-            napi_thingy argval(env);
-            argval = argv[0];
-            std::string evt = argval.as_str(true);
-            if (evt != "debug") NAPI_exc("unknown event type: '" << evt << "'");
-//            for (decltype(shmptr->m_frctl.cbs) cbp; cbp < &shmptr->m_frctl.cbs[SIZEOF(); ++cbp)
-#if 0 //evt emitter, cb lists, etc
-            for (auto itcb = cbs.begin(); itcb != cbs.end(); ++itcb)
-                if (itcb->state == NONE)
+            std::atomic<napi_threadsafe_function> fats; //asynchronous thread-safe JavaScript call-back function; can be called from any thread
+            std::atomic<napi_env> env; //env that owns fats
+            std::mutex mtx; //held by emit() while calling fats and by off() while releasing it, so fats can't be freed mid-call
+            bool once;
+            std::atomic<bool> pending; //coalesce: don't queue another call until previous one runs
+            std::atomic<int32_t> frnum, qent, coalesced;
+            std::atomic<elapsed_t> frtime, target;
+        };
+        static Listener* listeners(int port = 0) { static Listener m_listeners[MAX_PORTS][NUM_EVTS]; return &m_listeners[port][0]; } //kludge: avoid static member decl at global scope
+        static int evtinx(const std::string& evt) { return (evt == "present")? EVT_PRESENT: (evt == "free")? EVT_FREE: -1; }
+        static const char* evtname(int inx) { return (inx == EVT_PRESENT)? "present": (inx == EVT_FREE)? "free": "??EVT??"; }
+//notify JS; called by gpu wker (never blocks):
+        void emit(int evt, int32_t frnum, int32_t qent, elapsed_t frtime, elapsed_t target)
+        {
+            Listener& lsnr = listeners(port)[evt];
+            if (!lsnr.fats.load()) return; //no listener; fast path without lock
+            std::unique_lock<std::mutex> lock(lsnr.mtx, std::try_to_lock);
+            if (!lock.owns_lock()) return; //listener is being replaced or removed; drop evt rather than block gpu wker
+            napi_threadsafe_function fats = lsnr.fats.load();
+            if (!fats) return; //removed after check above
+            lsnr.frnum = frnum; lsnr.qent = qent; lsnr.frtime = frtime; lsnr.target = target; //latest info; JS cb reads it when it runs
+            if (lsnr.pending.exchange(true)) { ++lsnr.coalesced; return; } //JS hasn't seen previous evt yet
+            if (napi_call_threadsafe_function(fats, &lsnr, napi_tsfn_nonblocking) != napi_ok) lsnr.pending = false; //closing or que full; drop evt
+        }
+        void off(int evt)
+        {
+            Listener& lsnr = listeners(port)[evt];
+            std::lock_guard<std::mutex> lock(lsnr.mtx); //wait for in-flight emit() to finish with fats
+            napi_threadsafe_function fats = lsnr.fats.exchange(nullptr);
+            if (fats) napi_release_threadsafe_function(fats, napi_tsfn_release);
+        }
+//forget listeners owned by an env that is going away (worker_thread exit); Node already cleans up its fats
+        static void drop_listeners(napi_env env)
+        {
+            for (int port = 0; port < MAX_PORTS; ++port)
+                for (int evt = 0; evt < NUM_EVTS; ++evt)
                 {
-//void make_fats(napi_env env, napi_value jsfunc, napi_threadsafe_function_call_js napi_cb, napi_threadsafe_function* fats) //asynchronous thread-safe JavaScript call-back function; can be called from any thread
-                    make_fats(env, argv[1], On_cb, &itcb->fats); //, (void*)(itcb - cbs.begin())); //last arg = js cb func
-                    itcb->state = once? ONCE: REPEAT;
-                    argval = true;
-                    return argval;
+                    Listener& lsnr = listeners(port)[evt];
+                    std::lock_guard<std::mutex> lock(lsnr.mtx); //wait for in-flight emit()
+                    if (lsnr.env == env) { lsnr.fats = nullptr; lsnr.env = nullptr; }
                 }
-            NAPI_exc("too many '" << evt << "' event handlers (max is " << SIZEOF(cbs) << ")");
-            argval = false;
-#else //simpler async cb and bkg loop to watch for debug msgs
-            napi_threadsafe_function fats; //asynchronous thread-safe JavaScript call-back function; can be called from any thread
-            make_fats(env, argv[1], On_cb, &fats); //, (void*)(itcb - cbs.begin())); //last arg = js cb func
-            std::thread bkg([shmptr, once]()
+        }
+//promise waiters (openAsync, closeAsync, nextFrame):
+//gpu wker calls wake() when it starts, stops or finishes a frame; a bkg thread per port then settles promises on Node thread (via fats)
+//waits also re-check shm every few msec, so they still work when gpu wker is in another proc (daemon)
+//NOTE: like listeners, promises are process-local
+        enum { WAIT_OPEN = 0, WAIT_CLOSE, WAIT_FRAME };
+        struct Waiter
+        {
+            napi_deferred deferred;
+            napi_threadsafe_function fats;
+            napi_env env; //env that owns fats
+            int kind;
+            int32_t frnum; //WAIT_FRAME only
+            int32_t result; //numfr when settled
+            const char* error; //reject reason
+        };
+        struct Waitlist
+        {
+            std::mutex mtx;
+            std::condition_variable cv;
+            std::vector<Waiter*> pending;
+            std::atomic<int32_t> numpending; //gpu wker checks this without locking
+            bool running; //bkg thread exists
+        };
+        static Waitlist* waitlists(int port = 0) { static Waitlist m_waitlists[MAX_PORTS]; return &m_waitlists[port]; } //kludge: avoid static member decl at global scope
+//called by gpu wker (never blocks):
+        void wake()
+        {
+            Waitlist* wl = waitlists(port);
+            if (wl->numpending.load()) wl->cv.notify_all();
+            if (numfr_waiters.load()) VOID futex(&numfr, FUTEX_WAKE, INT_MAX); //waitFrame() callers, maybe in other procs
+        }
+//futex on a shm word; not private so waiters in other procs (or the daemon) see it:
+        static inline int futex(int32_t* addr, int op, int32_t val, const struct timespec* timeout = NULL) { return syscall(SYS_futex, addr, op, val, timeout, NULL, 0); }
+//check whether waiter can be settled yet:
+        bool settle(Waiter* waiter) const
+        {
+            const bool stopped = !isrunning && !supervised;
+            switch (waiter->kind)
+            {
+                case WAIT_OPEN:
+                    if (isrunning) break;
+                    if (protocol == Protocol::CANCEL) { waiter->error = "GPU port closed before it opened"; break; }
+                    if (stopped && exc_reason[0]) { waiter->error = "GPU port failed to open"; break; } //see exc_reason
+                    return false;
+                case WAIT_CLOSE:
+                    if (stopped) break;
+                    return false;
+                case WAIT_FRAME:
+                    if ((int32_t)(numfr - waiter->frnum) > 0) break; //fr# consumed by gpu wker
+                    if (stopped) { waiter->error = "GPU port is not open"; break; }
+                    return false;
+            }
+            waiter->result = numfr;
+            return true;
+        }
+//bkg thread uses its own shm attach, since the env that queued the first promise might detach first (worker_thread exit):
+        static void waiter_static(int port)
+        {
+            ShmData* shmptr = ShmData::my(shmalloc(sizeof(ShmData), ShmData::port_shmkey(port), SRCLINE));
+            waiter(port, (shmptr && shmptr->isvalid())? &shmptr->m_frctl: NULL); //reject all if attach failed
+            if (shmptr) shmfree(shmptr, SRCLINE);
+        }
+        static void waiter(int port, const FrameControl* fcptr)
+        {
+            static const int POLL_MSEC = 5; //re-check shm this often in case gpu wker is in another proc
+            Waitlist* wl = waitlists(port);
+            std::unique_lock<std::mutex> lock(wl->mtx);
+            while (!wl->pending.empty())
             {
-//                try
-                debug(12, PINK_MSG "bkg: %s(%s), shmdata %p, valid? %d" ENDCOLOR, once? "once": "on", evt.c_str(), shmptr, shmptr->isvalid());
-                for (;;) //sleep_msec(15)) //at 30 FPS, probably only need to check every 33 msec
+                for (auto it = wl->pending.begin(); it != wl->pending.end(); )
                 {
-                    std::string logstr = read_log_static(true);
-//                    if (!new_evts.length()) continue;
-//??                    if (!shmptr->isvalid()) break;
-                    size_t start = 0;
-//            while (start != string::npos)
-                    for (;;)
-                    {
-                        size_t end = logstr.find("\n", start);
-                        std::string msg = logstr.substr(start, (end == string::npos)? string::npos: end - start);
-                        
-                        if ((end == string::npos) || (end == logstr.length() - 1)) break;
-                        start = end;
-                    }
-                    
-                    if (once) break;
+                    if (!fcptr) (*it)->error = "can't attach GPU port shm";
+                    else if (!fcptr->settle(*it)) { ++it; continue; }
+                    napi_threadsafe_function fats = (*it)->fats;
+                    if (napi_call_threadsafe_function(fats, *it, napi_tsfn_nonblocking) != napi_ok) delete *it; //Node is exiting
+                    napi_release_threadsafe_function(fats, napi_tsfn_release); //queued call still runs
+                    it = wl->pending.erase(it);
                 }
-                debug(12, PINK_MSG "bkg exit: %s(%s), shmdata %p, valid? %d" ENDCOLOR, once? "once": "on", evt.c_str(), shmptr, shmptr->isvalid());
-            });
+                wl->numpending = wl->pending.size();
+                if (wl->pending.empty()) break;
+                wl->cv.wait_for(lock, std::chrono::milliseconds(POLL_MSEC));
+            }
+            wl->running = false;
+        }
+//forget waiters owned by an env that is going away (worker_thread exit); Node already tears down their fats, so don't call them
+        static void drop_waiters(napi_env env)
+        {
+            for (int port = 0; port < MAX_PORTS; ++port)
             {
-                DebugInOut("call fats for fr# " << commas(aoptr->/*m_frinfo.*/numfr.load()) << ", wait for 0x" << std::hex << Nodebuf::ALL_UNIV << std::dec << " (blocking)", SRCLINE);
-//                !NAPI_OK(napi_call_threadsafe_function(aoptr->fats, aoptr, napi_tsfn_blocking), "Can't call JS fats");
-//            while (aoptr->islistening()) //break; //allow cb to break out of playback loop
-//    typedef std::function<bool(void)> CANCEL; //void* (*REFILL)(mySDL_AutoTexture* txtr); //void);
-                aoptr->dirty.wait(Nodebuf::ALL_UNIV, [aoptr](){ return !aoptr->islistening(); }, true, SRCLINE); //CAUTION: blocks until al univ ready or caller cancelled
-//                const Uint32 palette[] = {RED, GREEN, BLUE, YELLOW, CYAN, PINK, WHITE};
-//                for (int i = 0; i < SIZEOF(aoptr->m_nodebuf.nodes); ++i) aoptr->m_nodebuf.nodes[0][i] = palette[aoptr->numfr.load() % SIZEOF(palette)];
-//                if (aoptr->numfr.load() >= 10) break;
-                debug(12, BLUE_MSG "bkg woke from fr# %s with ready 0x%x, caller listening? %d" ENDCOLOR, commas(aoptr->numfr.load()), aoptr->dirty.load(), aoptr->islistening());
-                if (!aoptr->islistening()) break;
-//                SDL_Delay(1 sec);
-                aoptr->update(); //env);
+                Waitlist* wl = waitlists(port);
+                std::lock_guard<std::mutex> lock(wl->mtx); //bkg thread holds this while calling fats
+                for (auto it = wl->pending.begin(); it != wl->pending.end(); )
+                {
+                    if ((*it)->env != env) { ++it; continue; }
+                    delete *it;
+                    it = wl->pending.erase(it);
+                }
+                wl->numpending = wl->pending.size();
             }
-//            SDL_Delay(1 sec);
-//https://stackoverflow.com/questions/233127/how-can-i-propagate-exceptions-between-threads
         }
-        catch (...)
+//create promise and queue a waiter for it:
+        static napi_value wait_async(napi_env env, FrameControl* fcptr, int kind, int32_t frnum = 0)
         {
-            aoptr->excptr = std::current_exception(); //allow main thread to rethrow
-            debug(12, RED_MSG "bkg wker exc: %s" ENDCOLOR, aoptr->exc_reason().c_str());
-//            aoptr->islistening(false); //listener.busy = true; //(void*)1;
+            napi_value promise, wker_name;
+            std::unique_ptr<Waiter> waiter(new Waiter{});
+            waiter->kind = kind;
+            waiter->frnum = frnum;
+            waiter->env = env;
+            !NAPI_OK(napi_create_promise(env, &waiter->deferred, &promise), "Cre promise failed");
+            !NAPI_OK(napi_create_string_utf8(env, "GpuPort promise", NAPI_AUTO_LENGTH, &wker_name), "Cre wkitem desc str failed");
+            !NAPI_OK(napi_create_threadsafe_function(env, NULL, NULL, wker_name, 0, 1, NO_FINAL_DATA, NO_FINALIZE, fcptr, Settle_cb, &waiter->fats), "Cre promise fats failed"); //keeps Node alive until settled
+            Waitlist* wl = waitlists(fcptr->port);
+            std::unique_lock<std::mutex> lock(wl->mtx);
+            wl->pending.push_back(waiter.release());
+            wl->numpending = wl->pending.size();
+            if (!wl->running) { wl->running = true; std::thread(waiter_static, fcptr->port).detach(); }
+            wl->cv.notify_all(); //might already be settled
+            return promise;
         }
-        aoptr->stop(); //env);
-//        !NAPI_OK(napi_release_threadsafe_function(aoptr->fats, napi_tsfn_release), "Can't release JS fats");
-//        aoptr->fats = NULL;
-//        aodata->listener.busy = false; //work = 0;
-        debug(12, YELLOW_MSG "bkg exit after %s frames" ENDCOLOR, commas(aoptr->/*m_frinfo.*/numfr.load()));
-    });
-    bkg.detach();
-
-
+//resolve/reject promise:
+//NOTE: this executes on Node main thread only
+        static void Settle_cb(napi_env env, napi_value js_func, void* context, void* data)
+        {
+            std::unique_ptr<Waiter> waiter(static_cast<Waiter*>(data));
+            if (!env) return; //Node cleanup mode
+            if (!waiter->error) { !NAPI_OK(napi_resolve_deferred(env, waiter->deferred, napi_thingy(env, waiter->result, napi_thingy::Int32{})), "Resolve promise failed"); return; }
+            napi_value errmsg, error;
+            !NAPI_OK(napi_create_string_utf8(env, waiter->error, NAPI_AUTO_LENGTH, &errmsg), "Cre error str failed");
+            !NAPI_OK(napi_create_error(env, NULL, errmsg, &error), "Cre error failed");
+            !NAPI_OK(napi_reject_deferred(env, waiter->deferred, error), "Reject promise failed");
+        }
+        static napi_value On_NAPI(napi_env env, napi_callback_info info, bool once)
+        {
+            if (!env) return NULL; //Node cleanup mode?
+            DebugInOut("On_napi");
 
+            FrameControl* fcptr;
+            napi_value argv[2+1], This; //allow 1 extra arg to check for extras
+            size_t argc = SIZEOF(argv);
+            !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&fcptr), "Get cb info failed");
+            if ((argc < 1) || (argc > 2)) NAPI_exc("expected 1-2 args: evt name, [cb], got " << argc << " arg" << plural(argc));
+            napi_thingy argval(env, argv[0]);
+            std::string evt = argval.as_str(true);
+            int inx = evtinx(evt);
+            if (inx < 0) NAPI_exc("unknown event type: '" << evt << "'");
+            fcptr->off(inx); //1 listener per evt; replace previous
+            if ((argc < 2) || (valtype(env, argv[1]) == napi_null) || (valtype(env, argv[1]) == napi_undefined)) return napi_thingy(env, false, napi_thingy::Boolean{}); //just remove listener
+            Listener& lsnr = listeners(fcptr->port)[inx];
+            lsnr.once = once;
+            lsnr.pending = false;
+            lsnr.coalesced = 0;
+            napi_threadsafe_function fats;
+            make_fats(env, argv[1], On_cb, &fats, fcptr);
+            !NAPI_OK(napi_unref_threadsafe_function(env, fats), "Unref JS fats failed"); //don't keep Node alive just for this
+            {
+                std::lock_guard<std::mutex> lock(lsnr.mtx);
+                lsnr.env = env;
+                lsnr.fats = fats;
+            }
+            debug(12, "on%s('%s') listener[%d] registered", once? "ce": "", evt.c_str(), inx);
+            return napi_thingy(env, true, napi_thingy::Boolean{});
+        }
+        static napi_value Off_NAPI(napi_env env, napi_callback_info info)
+        {
+            if (!env) return NULL; //Node cleanup mode?
+            DebugInOut("Off_napi");
 
-#endif
-            return argval;
+            FrameControl* fcptr;
+            napi_value argv[1+1], This; //allow 1 extra arg to check for extras
+            size_t argc = SIZEOF(argv);
+            !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&fcptr), "Get cb info failed");
+            if (argc > 1) NAPI_exc("expected 0-1 args: [evt name], got " << argc << " arg" << plural(argc));
+            napi_thingy argval(env, argc? argv[0]: napi_value(0));
+            int inx = argc? evtinx(argval.as_str(true)): NUM_EVTS;
+            if (inx < 0) NAPI_exc("unknown event type: '" << argval.as_str(true) << "'");
+            for (int i = 0; i < NUM_EVTS; ++i)
+                if ((inx == NUM_EVTS) || (i == inx)) fcptr->off(i); //no arg = remove all
+            return napi_thingy(env, true, napi_thingy::Boolean{});
         }
 //call Javascript callback function:
 //NOTE: this executes on Node main thread only
         static void On_cb(napi_env env, napi_value js_func, void* context, void* data)
         {
-            UNUSED(context);
-  // Retrieve the prime from the item created by the worker thread.
-//    int the_prime = *(int*)data;
-            ShmData* shmptr = static_cast<ShmData*>(data);
-            debug(11, "call On_cb fats: shmdata %p, valid? %d, context %p, clup mode? %d", shmptr, shmptr->isvalid(), context, !env);
-            if (!shmptr->isvalid()) NAPI_exc("shmdata invalid");
+            FrameControl* fcptr = static_cast<FrameControl*>(context);
+            Listener* lsnr = static_cast<Listener*>(data);
+            int inx = lsnr - listeners(fcptr->port);
+            lsnr->pending = false; //allow next evt to be queued; do this first so nothing is lost
   // env and js_cb may both be NULL if Node.js is in its cleanup phase, and
   // items are left over from earlier thread-safe calls from the worker thread.
-  // When env is NULL, we simply skip over the call into Javascript and free the
-  // items.
-            if (!env) return; //Node cleanup mode
-//            auto itcb = cbs.begin() + (int)context;
-//    {
-//    napi_thingy retval; retval.env = env;
-            std::string logstr = LogInfo::read_log_static();
-            napi_value argv[3];
-// Convert the integer to a napi_value.
-//NOTE: need to lazy-load params here because bkg wker didn't exist first time Listen_NAPI() was called
-//    aodata->wker_ok(env); //) NAPI_exc(env, "Gpu wker problem: " << aodata->exc_reason());
-            napi_thingy cb_arg(env), retval(env), This(env);
-//            for (const char* bp = )
-//https://stackoverflow.com/questions/53849/how-do-i-tokenize-a-string-in-c
-//#include <regex>
-//            std::regex reg("\\r?\\n");
-//            std::sregex_token_iterator iter(logstr.begin(), logstr.end(), reg, -1);
-//            std::sregex_token_iterator end;
-//            for (auto line: )
-//    vector<string> vec(iter, end);
-//    for (auto a : vec)      cout << a << endl;
-            size_t start = 0;
-//            while (start != string::npos)
-            for (;;)
-            {
-                size_t end = logstr.find("\n", start);
-                std::string msg = logstr.substr(start, (end == string::npos)? string::npos: end - start);
-                if ((end == string::npos) || (end == logstr.length() - 1)) break;
-                start = end;
+            if (!env || !js_func) return; //Node cleanup mode
+            debug(11, "call On_cb('%s') fats: frctl %p, fr# %d", evtname(inx), fcptr, lsnr->frnum.load());
+            napi_thingy evtinfo(env, napi_thingy::Object{}), retval(env), This(env);
+            vector_cxx17<my_napi_property_descriptor> props;
+            add_prop("evt", napi_thingy(env, evtname(inx)))(props.emplace_back());
+            add_prop("frnum", napi_thingy(env, lsnr->frnum.load(), napi_thingy::Int32{}))(props.emplace_back());
+            add_prop("qent", napi_thingy(env, lsnr->qent.load(), napi_thingy::Int32{}))(props.emplace_back());
+            add_prop("frtime", napi_thingy(env, lsnr->frtime.load(), napi_thingy::Uint32{}))(props.emplace_back());
+            add_prop("target", napi_thingy(env, lsnr->target.load(), napi_thingy::Uint32{}))(props.emplace_back());
+            add_prop("coalesced", napi_thingy(env, lsnr->coalesced.exchange(0), napi_thingy::Int32{}))(props.emplace_back()); //#evts merged into this one
+            evtinfo += props;
+            if (lsnr->once) fcptr->off(inx); //CAUTION: release before calling JS in case cb registers a new listener
 //CAUTION: seems to be some undocumented magic here: need to pass Undefined as "this" (2nd) arg here or else memory errors occur
 //see "this" at https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Operators/this#As_an_object_method
-                debug(10, "call js func with evt msg '" << msg << "'");
-                cb_arg = msg;
-                !NAPI_OK(napi_call_function(env, This, js_func, /*SIZEOF(argv)*/ 1, argv, &retval), "Call JS fats failed");
-            }
+            napi_value argv[] = {evtinfo};
+            !NAPI_OK(napi_call_function(env, This, js_func, SIZEOF(argv), argv, &retval), "Call JS fats failed");
         }
 #if 0
 //debug/diagnostic msgs:
@@ -827,7 +1097,8 @@ public: //dependent types:
 //        {
         std::atomic<int32_t> frnum; //, prevfr;
         std::atomic<elapsed_t> frtime, prevtime;
-        std::atomic<MASK_TYPE> ready; //per-univ Ready/dirty bits
+        BkgSync<MASK_TYPE> ready; //per-univ Ready/dirty bits; native setters only wake gpu wker when last univ is ready (JS Atomics.or just sets bits)
+        std::atomic<elapsed_t> target; //scheduled presentation time (epoch + frnum * frame_time)
 //        } frinfo; //per-frame state info
 //        uint8_t pad[];
 //        typedef /*alignas(CACHELEN)*/ NODEVAL UNIV[UNIV_MAXLEN]; //align univ to cache for better mem perf across cpus
@@ -846,7 +1117,7 @@ public: //dependent types:
         {
 //            HERE(7);
             ostrm << "{fr# " << commas(that.frnum.load()); //<< ", prev " << commas(that.prevfr.load());
-            ostrm << ", fr time " << commas(that.frtime.load()) << ", prev " << commas(that.prevtime.load()) << " msec";
+            ostrm << ", fr time " << commas(that.frtime.load()) << ", prev " << commas(that.prevtime.load()) << ", target " << commas(that.target.load()) << " msec";
             ostrm << ", ready 0x" << std::hex << that.ready.load() << std::dec;
             SDL_Size wh(SIZEOF(nodes), SIZEOF(nodes[0]));
             ostrm << ", nodes " << wh;
@@ -858,16 +1129,43 @@ public: //dependent types:
 //        static /*uint32_t*/ /*auto*/ napi_value frnum_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->frnum.load()); }
         static /*uint32_t*/ /*auto*/ napi_value frtime_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->frtime.load(), napi_thingy::Uint32{}); }
         static /*uint32_t*/ /*auto*/ napi_value prevtime_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->prevtime.load(), napi_thingy::Uint32{}); }
+        static /*uint32_t*/ /*auto*/ napi_value target_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->target.load(), napi_thingy::Uint32{}); }
         static /*uint32_t*/ /*auto*/ napi_value ready_getter(napi_env env, void* ptr) /*const*/ { return napi_thingy(env, my(ptr)->ready.load(), napi_thingy::Uint32{}); } //MASK_TYPE
         static void ready_setter(const napi_thingy& newval, void* ptr)
         {
 //NOTE: js "|=" uses getter + setter so it's not atomic; this setter implements "|=" semantics directly in here to ensure atomic updates
+//hot paths can use Atomics.or(hdr_u32, manifest.ready_inx, bits) instead; same lock-free 32-bit word, no native call
             uint32_t newbits = newval.as_uint32(true);
             uint32_t sv_ready = my(ptr)->ready.load(); //TODO: find out where upper 8 bits are being set
             if (newbits) my(ptr)->ready |= newbits;
             else my(ptr)->ready.store(0); //"|= 0" will reset value to 0
             debug(12, "ready 0x%x |= 0x%x => 0x%x", sv_ready, newbits, my(ptr)->ready.load());
         }
+//nodes[] getter; creates NUM_UNIV typed arrays on first access, then replaces itself with a plain prop (cached by the JS object)
+//saves module init time and heap in procs/threads that only touch a few nodebufs (or only use setUniverse/writeFrame)
+        static napi_value Nodes_NAPI(napi_env env, napi_callback_info info)
+        {
+            if (!env) return NULL; //Node cleanup mode?
+            FramebufQuent* fbptr;
+            napi_value This, hdr, arybuf;
+            size_t argc = 0, hdrlen, bofs;
+            napi_typedarray_type arytype;
+            void* data;
+            !NAPI_OK(napi_get_cb_info(env, info, &argc, NULL, &This, (void**)&fbptr), "Get cb info failed");
+//reuse arybuf from hdr view rather than creating another external arybuf over same shm:
+            !NAPI_OK(napi_get_named_property(env, This, "hdr_u32", &hdr), "Get hdr view failed");
+            !NAPI_OK(napi_get_typedarray_info(env, hdr, &arytype, &hdrlen, &data, &arybuf, &bofs), "Get hdr view info failed");
+            napi_thingy univ_ary(env, napi_thingy::Array{}, NUM_UNIV);
+            for (int x = 0; x < /*wh.w*/ NUM_UNIV; ++x)
+            {
+                napi_thingy node_typary(env, GPU_NODE_type, /*wh.h*/ SIZEOF(fbptr->nodes[0]), arybuf, bofs + x * sizeof(fbptr->nodes[0]) + addrof(&fbptr->nodes[0][0]) - addrof(fbptr));
+                !NAPI_OK(napi_set_element(env, univ_ary, x, node_typary), "Cre inner node typary failed");
+            }
+            vector_cxx17<my_napi_property_descriptor> props;
+            add_prop("nodes", univ_ary)(props.emplace_back());
+            napi_thingy(env, This) += props; //replace getter; next access is a plain prop read
+            return univ_ary;
+        }
 //??        static STATIC_WRAP(napi_ref, m_nodes_ref, = nullptr);
         static intptr_t addrof(void* member) { return (intptr_t)member; } //kludge: bypass compiler's refusal to give address of data members
 //        size_t my_offset_of(void* member) { intptr_t ptr = member; return ptr; }
@@ -883,6 +1181,7 @@ public: //dependent types:
             add_getter("frnum", FramebufQuent::frnum_getter, this)(props.emplace_back());
             add_getter("frtime", FramebufQuent::frtime_getter, this)(props.emplace_back());
             add_getter("prevtime", FramebufQuent::prevtime_getter, this)(props.emplace_back());
+            add_getter("target", FramebufQuent::target_getter, this)(props.emplace_back());
             add_getter("ready", FramebufQuent::ready_getter, FramebufQuent::ready_setter, this)(props.emplace_back());
 //            for (auto& it = m_fbque.begin(); it != m_fbque.end(); ++it)
 //            {
@@ -893,15 +1192,19 @@ public: //dependent types:
 //                !NAPI_OK(napi_create_array_with_length(env, NUM_UNIV, &univ_ary.value), "Cre univ ary failed");
 //            FramebufQuent* ofs_ptr = 0;
 //            intptr_t ofs_of_nodes = &ofs_ptr->nodes[0][0];
-            napi_thingy univ_ary(env, napi_thingy::Array{}, NUM_UNIV);
-            for (int x = 0; x < /*wh.w*/ NUM_UNIV; ++x)
-            {
+//            napi_thingy univ_ary(env, napi_thingy::Array{}, NUM_UNIV);
+//            for (int x = 0; x < /*wh.w*/ NUM_UNIV; ++x)
+//            {
 //TODO: add handle_scope? https://nodejs.org/api/n-api.html#n_api_making_handle_lifespan_shorter_than_that_of_the_native_method
 //                debug(33, "cre typed ary, ofs %d x %s + %d x %s + %u = %s", inx, commas(sizeof(*this)), x, commas(sizeof(nodes[0])), addrof(&nodes[0][0]) - addrof(this), commas(inx * sizeof(*this) + x * sizeof(nodes[0]) + addrof(&nodes[0][0]) - addrof(this))); //UNIV_MAXLEN * sizeof(NODEVAL)); //sizeof(nodes[0][0]));
-                napi_thingy node_typary(env, GPU_NODE_type, /*wh.h*/ SIZEOF(nodes[0]) /*UNIV_MAXLEN_pad*/ /*_raw*/, arybuf, inx * sizeof(*this) + x * sizeof(nodes[0]) + addrof(&nodes[0][0]) - addrof(this)); //UNIV_MAXLEN * sizeof(NODEVAL)); //sizeof(nodes[0][0]));
-                !NAPI_OK(napi_set_element(env, univ_ary, x, node_typary), "Cre inner node typary failed");
-            }
-            add_prop("nodes", univ_ary)(props.emplace_back());
+//                napi_thingy node_typary(env, GPU_NODE_type, /*wh.h*/ SIZEOF(nodes[0]) /*UNIV_MAXLEN_pad*/ /*_raw*/, arybuf, inx * sizeof(*this) + x * sizeof(nodes[0]) + addrof(&nodes[0][0]) - addrof(this)); //UNIV_MAXLEN * sizeof(NODEVAL)); //sizeof(nodes[0][0]));
+//                !NAPI_OK(napi_set_element(env, univ_ary, x, node_typary), "Cre inner node typary failed");
+//            }
+//            add_prop("nodes", univ_ary)(props.emplace_back());
+            NAMED{ _.utf8name = "nodes"; _.getter = FramebufQuent::Nodes_NAPI; _.attributes = static_cast<napi_property_attributes>(napi_enumerable | napi_configurable); _.data = this; }(props.emplace_back()); //lazy; configurable so getter can replace itself
+//raw header words; see manifest.*_inx:
+            add_prop("hdr_i32", napi_thingy(env, napi_int32_array, (addrof(&nodes[0][0]) - addrof(this)) / 4, arybuf, inx * sizeof(*this)))(props.emplace_back());
+            add_prop("hdr_u32", napi_thingy(env, napi_uint32_array, (addrof(&nodes[0][0]) - addrof(this)) / 4, arybuf, inx * sizeof(*this)))(props.emplace_back());
 //#if 1 //does this work?
 //        std::atomic<int32_t> frnum, prevfr;
 //        std::atomic<elapsed_t> frtime, prevtime;
@@ -963,7 +1266,8 @@ public: //data members (visible to bkg wkers via shm)
 //    InOutDebug inout2;
 public: //ctors/dtors
 //    explicit ShmData(int new_screen, const SDL_Size& new_wh, double new_frame_time): info(new_screen, new_wh, new_frame_time) {}
-    explicit ShmData(): /*inout1("1"), inout2("2"),*/ m_frctl(-1, SDL_Size(0, 0), 0) { /*HERE(2);*/ INSPECT(GREEN_MSG "ctor " << *this); } //set junk values until bkg wker starts
+    explicit ShmData(int port = 0): /*inout1("1"), inout2("2"),*/ m_manifest(port), m_frctl(-1, SDL_Size(0, 0), 0) { m_frctl.port = port; /*HERE(2);*/ INSPECT(GREEN_MSG "ctor " << *this); } //set junk values until bkg wker starts
+    static key_t port_shmkey(int port = 0) { return FramebufQuent::SHMKEY + (port << 16); } //show port# in key (ipcs -m)
     ~ShmData() { INSPECT(RED_MSG "dtor " << *this); }
 public: //operators
     bool isvalid() const { return !isnull(this) && (m_hdr == VALIDCHK) && (m_flag1 == VALIDCHK) && (m_flag2 == VALIDCHK) && (m_tlr == VALIDCHK); }
@@ -1039,7 +1343,9 @@ public: //methods:
     {
         if (!isvalid()) return false;
 //        return (isvalid() && m_frctl.isrunning); //(m_frctl.protocol != Protocol::CANCEL)); }
-        return m_frctl.isrunning = yesno;
+        m_frctl.isrunning = yesno;
+        m_frctl.wake(); //settle openAsync/closeAsync promises
+        return yesno;
     }
     void init_fbque(NODEVAL color = BLACK)
     {
@@ -1050,6 +1356,7 @@ public: //methods:
             it->ready.store(0);
             it->frnum = it - m_fbque.begin(); //initially set to 0, 1, 2, ...
             it->prevtime = it->frtime = 0; //it->frnum * m_frctl.frame_time; //deadline for this frame based on known frame_time; float -> int
+            it->target = 0; //set when playback starts (epoch not known yet)
 //            it->prevtime = it->prevfr = -1; //no previous frame
 //NOTE: loop (1 write/element) is more efficient than memcpy (1 read + 1 write / element)
             for (int i = 0; i < SIZEOF_2D(it->nodes); ++i) it->nodes[0][i] = color; //BLACK; //clear *entire* buf in case h < max and caller wants linear (1D) addressing
@@ -1063,21 +1370,160 @@ public: //methods:
         debug(44, "init %d fbque ents to 0x%x", SIZEOF(m_fbque), color);
 //also init gpu wker stats:
         m_frctl.numfr = 0;
+        m_frctl.numtween = 0;
+        m_frctl.numpartial = 0;
+        m_frctl.numdrop = m_frctl.drift_msec = m_frctl.maxdrift_msec = 0;
+        m_frctl.numrestart = 0;
+        m_frctl.restart_reason[0] = '\0';
+        memset(&m_frctl.univ_late[0], 0, sizeof(m_frctl.univ_late));
         memset(&m_frctl.perf_stats[0], 0, sizeof(m_frctl.perf_stats));
     }
+//timing solver: check real video timing against WS281X protocol and choose vgroup for requested univ len:
+    struct Timing
+    {
+        int screen = FIRST_SCREEN;
+        int vgroup = 1; //#scan rows per node
+        int univlen = 0; //#nodes per univ with this vgroup
+        int maxlen = 0; //#nodes per univ that still refresh at requested fps
+        double fps = 0, row_usec = 0, bit_usec = 0, hblank_usec = 0, vblank_usec = 0;
+        bool ok = false;
+        char why[80] = "";
+    };
+    static Timing solve_timing(int screen = FIRST_SCREEN, int want_univlen = 0, double want_fps = 0, int vgroup = 0, SrcLine srcline = 0)
+    {
+        static const int COMPILED_MAXLEN = rndup(UNIV_MAXLEN, CACHELEN); //node buf row len
+        Timing sol;
+        sol.screen = screen;
+        sol.vgroup = std::max(vgroup, 1);
+        const ScreenConfig* cfg = getScreenConfig(screen, srcline);
+        const int rows = ScreenInfo(screen, srcline)->bounds.h; //same as gpu wker uses
+        if (!cfg || !cfg->dot_clock || !cfg->htotal || !cfg->vtotal || !rows) { snprintf(sol.why, sizeof(sol.why), "no video config for screen %d", screen); return sol; }
+        sol.row_usec = 1e3 * cfg->htotal / cfg->dot_clock; //dot clock is KHz
+        sol.bit_usec = sol.row_usec / NODEBITS;
+        sol.hblank_usec = 1e3 * (cfg->htotal - cfg->hdisplay) / cfg->dot_clock;
+        sol.vblank_usec = sol.row_usec * (cfg->vtotal - cfg->vdisplay);
+        sol.fps = cfg->fps(srcline);
+        if (!vgroup) vgroup = divup(rows, want_univlen? std::min(want_univlen, COMPILED_MAXLEN): COMPILED_MAXLEN); //fewest repeated rows that fit
+        sol.vgroup = std::max(vgroup, 1);
+        sol.univlen = std::min(divup(rows, sol.vgroup), COMPILED_MAXLEN);
+        const int fps_rows = want_fps? (int)(1e3 * cfg->dot_clock / cfg->htotal / want_fps) - (cfg->vtotal - cfg->vdisplay): rows; //VRES_CONSTRAINT less vblank
+        sol.maxlen = std::min(std::max(fps_rows, 0) / sol.vgroup, COMPILED_MAXLEN);
+        if ((sol.bit_usec < BIT_USEC_MIN) || (sol.bit_usec > BIT_USEC_MAX)) snprintf(sol.why, sizeof(sol.why), "bit time %4.3f usec outside %4.3f..%4.3f", sol.bit_usec, BIT_USEC_MIN, BIT_USEC_MAX);
+        else if (sol.hblank_usec > HBLANK_USEC_MAX) snprintf(sol.why, sizeof(sol.why), "hblank %4.3f usec > %4.3f", sol.hblank_usec, HBLANK_USEC_MAX);
+        else if (sol.vblank_usec < LATCH_USEC_MIN) snprintf(sol.why, sizeof(sol.why), "vblank %4.1f usec < latch %4.1f", sol.vblank_usec, LATCH_USEC_MIN);
+        else if (want_fps && (sol.fps < want_fps * 0.99)) snprintf(sol.why, sizeof(sol.why), "video %4.2f fps < requested %4.2f", sol.fps, want_fps);
+        else if (want_univlen > std::min(sol.univlen, sol.maxlen)) snprintf(sol.why, sizeof(sol.why), "univ len %d > max %d", want_univlen, std::min(sol.univlen, sol.maxlen));
+        else { strcpy(sol.why, "ok"); sol.ok = true; }
+        debug(12, "timing[%d]: vgroup %d, univ len %d (max %d), %4.2f fps, row %4.3f usec, bit %4.3f usec, hblank %4.3f usec, vblank %4.1f usec: %s" << ATLINE(srcline), screen, sol.vgroup, sol.univlen, sol.maxlen, sol.fps, sol.row_usec, sol.bit_usec, sol.hblank_usec, sol.vblank_usec, sol.why);
+        return sol;
+    }
 //unresolved    template <typename ... ARGS>
 //    static void gpu_wker_static(ShmData* shmptr, ARGS&& ... args) //shim for std::thread()
 //    {
 //        shmptr->gpu_wker(std::forward<ARGS>(args) ...); //perfect fwd
 //    }
-    static void gpu_wker_static(ShmData* shmptr, int NUMFR = INT_MAX, int screen = FIRST_SCREEN, SDL_Size* want_wh = NO_SIZE, size_t vgroup = 1, NODEVAL init_color = BLACK, SrcLine srcline = 0) //shim for std::thread()
+    static void gpu_wker_static(ShmData* shmptr, int NUMFR = INT_MAX, int screen = FIRST_SCREEN, SDL_Size* want_wh = NO_SIZE, size_t vgroup = 1, NODEVAL init_color = BLACK, bool resume = false, SrcLine srcline = 0) //shim for std::thread()
     {
-        shmptr->gpu_wker(NUMFR, screen, want_wh, vgroup, init_color, srcline); //TODO: perfect fwd
+        shmptr->gpu_wker(NUMFR, screen, want_wh, vgroup, init_color, resume, srcline); //TODO: perfect fwd
+    }
+    static void watchdog_static(ShmData* shmptr, int screen = FIRST_SCREEN, size_t vgroup = 1, NODEVAL init_color = BLACK, SrcLine srcline = 0) //shim for std::thread()
+    {
+        shmptr->watchdog(screen, vgroup, init_color, srcline);
+    }
+//supervise gpu wker; restart with same settings if it dies, report if it stops making progress:
+//NOTE: a stalled thread can't be killed and might still be inside txtr.update() on the display, so it is not replaced;
+//a dead one has already torn down its txtr (isrunning is cleared last), so only one wker owns the display at a time
+//CAUTION: caller sets supervised before starting wker + watchdog so a wker that dies early doesn't cancel the port
+    void watchdog(int screen = FIRST_SCREEN, size_t vgroup = 1, NODEVAL init_color = BLACK, SrcLine srcline = 0)
+    {
+        static const int MIN_MSEC = 100; //frame_time not known until gpu wker starts
+        bool stalled = false; //report each stall once
+        debug(12, "watchdog start: %d frame times" << ATLINE(srcline), m_frctl.watchdog);
+        for (;;)
+        {
+            const int limit_msec = std::max<int>(m_frctl.watchdog * m_frctl.frame_time, MIN_MSEC);
+            SDL_Delay(limit_msec / 2);
+            if (m_frctl.protocol == Protocol::CANCEL) break; //caller closed port
+            if (m_frctl.isrunning && m_frctl.heartbeat && ((int32_t)(Now() - m_frctl.heartbeat) > limit_msec))
+            {
+                if (stalled) continue;
+                stalled = true;
+                snprintf(m_frctl.restart_reason, sizeof(m_frctl.restart_reason), "stalled at fr# %d", m_frctl.numfr);
+                exc_soft("gpu wker %s; waiting for it to recover or die", m_frctl.restart_reason);
+                continue;
+            }
+            stalled = false;
+            if (m_frctl.isrunning || !m_frctl.exc_reason[0]) continue; //still going, or not started yet
+            snprintf(m_frctl.restart_reason, sizeof(m_frctl.restart_reason), "died at fr# %d: %s", m_frctl.numfr, m_frctl.exc_reason);
+            exc_soft("gpu wker %s; restarting", m_frctl.restart_reason);
+            ++m_frctl.numrestart;
+            ++m_frctl.generation; //identifies current wker
+            m_frctl.exc_reason[0] = '\0';
+            m_frctl.heartbeat = 0; //don't check stall until new wker is running
+            std::thread bkg(gpu_wker_static, this, INT_MAX, screen, NO_SIZE, vgroup, init_color, true, &SRCLINE[0]); //resume from current fr#
+            bkg.detach();
+        }
+        m_frctl.supervised = false;
+        debug(12, "watchdog exit after %d restart%s", m_frctl.numrestart, plural(m_frctl.numrestart));
+    }
+//run gpu wker in a separate proc so a Node crash or redeploy doesn't blank the display; returns daemon pid to caller:
+//NOTE: double fork so daemon is reparented to init (no zombie) and setsid() so it doesn't get the Node proc's ^C or SIGHUP
+//CAUTION: Node proc is multi-threaded; a lock held by another thread at fork() time stays locked in the child, so children only make async-signal-safe calls until exec()
+//daemon is a fresh Node proc running daemonMain() from this addon; it attaches to this port by shm key and takes its options from shm
+    pid_t daemonize(int screen = FIRST_SCREEN, size_t vgroup = 1, NODEVAL init_color = BLACK, SrcLine srcline = 0)
+    {
+        char node_exe[PATH_MAX];
+        ssize_t len = readlink("/proc/self/exe", node_exe, sizeof(node_exe) - 1);
+        if (len <= 0) exc_hard("can't find node exe: %s", strerror(errno));
+        node_exe[len] = '\0';
+        Dl_info addon; //find my own .node file so daemon loads the same build
+        if (!dladdr((void*)&GpuModuleInit, &addon) || !addon.dli_fname) exc_hard("can't find addon path");
+        std::string args[] = {std::to_string(m_frctl.port), std::to_string(screen), std::to_string(vgroup), std::to_string(init_color)};
+        const char* argv[] = {node_exe, "-e", "require(process.argv[1]).daemonMain(+process.argv[2], +process.argv[3], +process.argv[4], +process.argv[5])", addon.dli_fname, args[0].c_str(), args[1].c_str(), args[2].c_str(), args[3].c_str(), NULL}; //build before fork(); no heap after
+        int pipefd[2];
+        if (pipe2(pipefd, O_CLOEXEC)) exc_hard("daemon pipe failed: %s", strerror(errno));
+        pid_t pid = fork();
+        if (pid < 0) { close(pipefd[0]); close(pipefd[1]); exc_hard("daemon fork failed: %s", strerror(errno)); }
+        if (pid) //Node proc: wait for intermediate child to report daemon pid
+        {
+            pid_t daemon_pid = -1;
+            int exec_errno = 0;
+            close(pipefd[1]);
+            if (read(pipefd[0], &daemon_pid, sizeof(daemon_pid)) != sizeof(daemon_pid)) daemon_pid = -1;
+            if (read(pipefd[0], &exec_errno, sizeof(exec_errno)) == sizeof(exec_errno)) daemon_pid = -1; //pipe closes on exec; data means exec failed
+            close(pipefd[0]);
+            VOID waitpid(pid, NULL, 0); //reap intermediate child
+            if (daemon_pid <= 0) exc_hard("daemon start failed: %s", exec_errno? strerror(exec_errno): "fork");
+            debug(12, "daemon pid %d started: %s %s" << ATLINE(srcline), daemon_pid, node_exe, addon.dli_fname);
+            return m_frctl.daemon = daemon_pid;
+        }
+        close(pipefd[0]);
+        VOID setsid(); //new session; detach from Node proc's terminal
+        pid = fork();
+        if (pid) { VOID write(pipefd[1], &pid, sizeof(pid)); _exit(0); } //intermediate child; pid -1 tells Node proc it failed
+        execv(node_exe, const_cast<char* const*>(argv));
+        int exec_errno = errno;
+        VOID write(pipefd[1], &exec_errno, sizeof(exec_errno));
+        _exit(127);
+    }
+//daemon proc: run gpu wker (and watchdog) until caller closes port:
+//NOTE: blocks the daemon's JS thread; daemon proc has nothing else to do
+    void daemon_main(int screen = FIRST_SCREEN, size_t vgroup = 1, NODEVAL init_color = BLACK, SrcLine srcline = 0)
+    {
+        VOID signal(SIGHUP, SIG_IGN);
+        VOID signal(SIGPIPE, SIG_IGN);
+        m_frctl.daemon = getpid();
+        debug(12, "daemon pid %d running, #attch %d" << ATLINE(srcline), m_frctl.daemon, shmnattch(this));
+        if (m_frctl.watchdog) std::thread(watchdog_static, this, screen, vgroup, init_color, &SRCLINE[0]).detach();
+        gpu_wker(INT_MAX, screen, NO_SIZE, vgroup, init_color, false, srcline);
+        while (m_frctl.supervised || isopen()) SDL_Delay(100); //watchdog might have restarted gpu wker
+        debug(12, "daemon pid %d exit after %s frames", m_frctl.daemon, commas(m_frctl.numfr));
+        m_frctl.daemon = 0;
     }
 //start bkg gpu wker; the gpu "port" is "open" while this is running
 //NOTE: this should be run on a separate thread so it doesn't block the Node event loop
 //NOTE also: SDL is not thread-safe, so it needs to be a dedicated thread
-    void gpu_wker(int NUMFR = INT_MAX, int screen = FIRST_SCREEN, SDL_Size* want_wh = NO_SIZE, size_t vgroup = 1, NODEVAL init_color = BLACK, SrcLine srcline = 0)
+    void gpu_wker(int NUMFR = INT_MAX, int screen = FIRST_SCREEN, SDL_Size* want_wh = NO_SIZE, size_t vgroup = 1, NODEVAL init_color = BLACK, bool resume = false, SrcLine srcline = 0)
     {
         std::string exc_msg;
         decltype(Now()) started = Now();
@@ -1114,13 +1560,34 @@ public: //methods:
 //        m_txtr(TXTR::NullOkay{}), //leave empty until bkg thread starts
             TXTR txtr = TXTR::create(NAMED{ _.wh = &txtr_wh; _.view_wh = &view, _.screen = screen; _.init_color = init_color; SRCLINE; });
 //        m_txtr = newtxtr; //kludge: G++ thinks m_txtr is a ref so assign create() to temp first
-            TXTR::XFR xfr = std::bind(xfr_bb, std::ref(*this), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, SRCLINE); //protocol bit-banger shim
+//partial frames: keep private copy of previous bit-banged txtr so late univ can reuse their columns (txtr is overwritten by stretch):
+            std::unique_ptr<XFRTYPE[]> bbprev(m_frctl.deadline_msec? new XFRTYPE[BIT_SLICES * m_frctl.wh.h](): nullptr);
+            TXTR::XFR xfr = std::bind(xfr_bb, std::ref(*this), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, bbprev.get(), SRCLINE); //protocol bit-banger shim
+//tween history: fbque ents are recycled by render wkers, so keep private copy of last 2 complete frames + synthesized frame:
+            using NODEBUF = decltype(m_fbque[0].nodes);
+            std::unique_ptr<NODEBUF[]> tweenbuf((m_frctl.tween == FrameControl::TWEEN_BLEND)? new NODEBUF[3]: nullptr);
+            int numhist = 0; //#complete frames in history
+//pipelined: update() returns when frame is handed to presenter, once previous one is on screen; stamp + emit that one then
+            FramebufQuent* pipe_it = NULL; //frame handed off but not stamped yet
+            int32_t pipe_frnum = 0;
+            elapsed_t pipe_target = 0;
+            auto presented = [this](FramebufQuent* it, int32_t frnum, elapsed_t target, elapsed_t frtime)
+            {
+                it->prevtime.store(it->frtime.load()); //save previous so caller can decide how to apply updates
+                it->frtime = m_frctl.latest = frtime;
+                m_frctl.drift_msec = (int32_t)(frtime - target);
+                if (abs(m_frctl.drift_msec) > abs(m_frctl.maxdrift_msec)) m_frctl.maxdrift_msec = m_frctl.drift_msec;
+                m_frctl.emit(FrameControl::EVT_PRESENT, frnum, it - &m_fbque[0], frtime, target);
+            };
 //TODO: refill not needed?
-            txtr.clear_stats(&m_frctl.perf_stats[0]); //perftime(); //kludge: flush perf timer, but leave a little overhead so first-time results are realistic
+            txtr.clear_stats(resume? NO_PERF: &m_frctl.perf_stats[0]); //perftime(); //kludge: flush perf timer, but leave a little overhead so first-time results are realistic
 //            elapsed_t first_caller_correction;
 //}
             debug(19, "bkg gpu txtr " << txtr);
-            init_fbque(init_color); //do this *before* set running state, but after determining frame_time
+            rt_setup(SRCLINE); //CAUTION: must be called from gpu wker thread
+            if (m_frctl.pipeline) txtr.pipeline(true, SRCLINE); //presenter thread inherits rt settings from here
+            if (!resume) init_fbque(init_color); //do this *before* set running state, but after determining frame_time; restart keeps fbque so render wkers aren't disturbed
+            m_frctl.owner = getpid();
             isopen(true); //m_frctl.isrunning = true;
 //debug("here52" ENDCOLOR);
 //        m_txtr = txtr.release(); //kludge: xfr ownership from temp to member
@@ -1148,26 +1615,65 @@ public: //methods:
 //        elapsed_msec_t started = elapsed_msec(), previous = started, delta;
 //            const int delay_msec = 1000; //2 msec;
             started = Now(); //reset timebase so timing stats are just for render loop
+            if (!resume) m_frctl.epoch = started; //show epoch; frame targets are scheduled from here
+            if (!resume) for (auto it = m_fbque.begin(); it != m_fbque.end(); ++it) it->target = sched(it->frnum);
 //debug(0, "elapsed " << (now() - started) << ", " << (1000 * (now() - started)));
             debug(12, "gpu_wkr start playback loop");
-            for (int frnum = 0; frnum < NUMFR; m_frctl.numfr = ++frnum) //no-CAUTION: numfr pre-inc to account for clear_stats() at end of first iter; //int i = 0; i < 5; ++i)
+            for (int frnum = resume? m_frctl.numfr: 0; frnum < NUMFR; m_frctl.numfr = ++frnum) //no-CAUTION: numfr pre-inc to account for clear_stats() at end of first iter; //int i = 0; i < 5; ++i)
 //        for (auto it = fbque.begin(true); info.Protocol != CANCEL; ++it) //CAUTION: circular queue
             {
 //        let qent = frnum % frctl.length; //simple, circular queue
                 FramebufQuent* it = &m_fbque[frnum % SIZEOF(m_fbque)]; //CAUTION: circular queue
+                m_frctl.heartbeat = Now();
+                m_frctl.wake(); //previous frames consumed; settle nextFrame promises
                 if (it->frnum != frnum) exc_hard("frbuf que addressing messed up: got fr#%d, wanted %d", it->frnum.load(), frnum); //main is only writer; this shouldn't happen!
                 int wait_frames = 0;
+                decltype(Now()) commit_at = (m_frctl.catchup? it->target.load(): m_frctl.latest + m_frctl.frame_time) - m_frctl.deadline_msec; //partial frame deadline (if enabled)
                 while ((it->ready & ALL_UNIV) != ALL_UNIV) //wait for all wkers to render nodes (ignore unused bits); wait means wkers are running too slow
                 {
-                    VOID txtr.idle(NO_PERF, SRCLINE); //wait for next vsync
+                    if (m_frctl.protocol == Protocol::CANCEL) break; //don't keep tweening after close()
+                    m_frctl.heartbeat = Now(); //still alive, just waiting for render wkers
+                    if (toolate(it)) break; //drop it (below)
+                    if (m_frctl.deadline_msec) //commit partial frame at deadline
+                    {
+                        if (Now() < commit_at) { VOID it->ready.wait_all(ALL_UNIV, (int32_t)(commit_at - Now()), SRCLINE); continue; } //futex wait until all univ ready or deadline; vsync wait would overshoot deadline
+                        if (it->ready & ALL_UNIV) break; //commit univ that are ready; late univ reuse previous bits
+                        commit_at += m_frctl.frame_time; //nothing ready yet; try again next frame
+                    }
+//missed deadline: synthesize in-between frame from last 2 complete frames, or just leave previous frame on screen:
+                    if (tweenbuf && (numhist >= 2))
+                    {
+                        tween_avg(&tweenbuf[2][0][0], &tweenbuf[numhist & 1][0][0], &tweenbuf[(numhist - 1) & 1][0][0], SIZEOF_2D(tweenbuf[2])); //older, newer
+                        VOID txtr.update(NAMED{ _.pixels = &tweenbuf[2][0][0]; _.perf = NO_PERF; _.xfr = xfr; SRCLINE; });
+                        if (pipe_it) { presented(pipe_it, pipe_frnum, pipe_target, txtr.presented()); pipe_it = NULL; } //tween was handed off after it
+                    }
+                    else VOID txtr.idle(NO_PERF, SRCLINE); //wait for next vsync
+                    if (m_frctl.tween) ++m_frctl.numtween;
 //                    debug(15, YELLOW_MSG "fr[%d/%d] buf[%d/%d] not ready: 0x%x, gpu wker wait %d msec for wkers to render ...", frnum, NUMFR, it - &m_fbque[0], SIZEOF(m_fbque), it->ready.load(), delay_msec);
 //                    SDL_Delay(delay_msec); //2 msec); //timing is important; don't wait longer than needed
                     ++wait_frames;
                 }
 //                if (wait_frames) debug(15, YELLOW_MSG "qpu wker fr[%d/%d] waited %s frame times (%s msec) for buf[%d/%d] ready", frnum, NUMFR, commas(wait_frames), commas(wait_frames * m_frctl.frame_time), it - &m_fbque[0], SIZEOF(m_fbque));
                 if (wait_frames) debug(15, "gpu_wkr fr[%d] waited %d", frnum, wait_frames);
+                if (toolate(it) && (m_frctl.protocol != Protocol::CANCEL)) //skip ahead to keep wall-clock sync
+                {
+                    debug(15, "gpu_wkr drop fr[%d]: target %s, now %s", frnum, commas(it->target.load()), commas(Now()));
+                    ++m_frctl.numdrop;
+                    recycle(it); //tell wkers to render a later frame
+                    continue;
+                }
+                while (m_frctl.catchup && ((int32_t)(it->target - Now()) > m_frctl.frame_time / 2) && (m_frctl.protocol != Protocol::CANCEL)) //early; hold previous frame until target
+                    VOID txtr.idle(NO_PERF, SRCLINE);
+                const MASK_TYPE late = ~it->ready.load() & ALL_UNIV; //univ that missed deadline
+                if (late && (m_frctl.protocol != Protocol::CANCEL))
+                {
+                    ++m_frctl.numpartial;
+                    for (int x = 0; x < NUM_UNIV; ++x)
+                        if (late & univ_bit(x)) ++m_frctl.univ_late[x];
+                    debug(15, "gpu_wkr fr[%d] partial: late 0x%x", frnum, late);
+                }
 //            delta = elapsed.now() - previous; perf_stats[0] += delta; previous += delta;
-//TODO: tweening for missing/!ready frames?
+//tweening for missing/!ready frames is done above (optional)
 //        static const decltype(m_frinfo.elapsed_msec()) TIMING_SLOP = 5; //allow +/-5 msec
 //        const decltype(m_frinfo.elapsed_msec()) /*elapsed_t*/ overdue = m_opts.frtime_msec? m_frinfo.elapsed_msec() - numfr.load() * m_opts.frtime_msec: 0, delay = (overdue < -TIMING_SLOP/2)? -overdue: 0;
 //        const char* severity = /*((overdue < -10) || (overdue > 10))? RED_MSG:*/ PINK_MSG;
@@ -1178,17 +1684,20 @@ public: //methods:
 //                if (!(frnum % 50)) debug(0, "elapsed " << (now() - started) << ", " << (1000 * (now() - started)));
                 if (m_frctl.protocol == Protocol::CANCEL) break;
                 VOID txtr.update(NAMED{ _.pixels = /*&m_xfrbuf*/ &it->nodes[0][0]; _.perf = &m_frctl.perf_stats[1-1]; _.xfr = xfr; /*_.refill = refill;*/ SRCLINE; });
-                it->prevtime.store(it->frtime.load()); //save previous so caller can decide how to apply updates
-                it->frtime = m_frctl.latest = txtr.m_latest; //just echo txtr; //now() - started;
+                if (!txtr.pipelined()) presented(it, frnum, it->target, txtr.m_latest); //just echo txtr; //now() - started;
+                else //slot might be recycled before presenter shows it, so remember what to stamp
+                {
+                    if (pipe_it) presented(pipe_it, pipe_frnum, pipe_target, txtr.presented());
+                    pipe_it = it; pipe_frnum = frnum; pipe_target = it->target;
+                }
+                if (tweenbuf && !late) memcpy(&tweenbuf[numhist++ & 1][0][0], &it->nodes[0][0], sizeof(it->nodes)); //save before render wkers reuse it
                 if (!(frnum % 120)) debug(15, "gpu_wkr fr[%d] rendered", frnum);
 //                ++m_frctl.perf_stats[0]; //moved to txtr
 //            m_frctl.numfr = frnum + 1;
 //TODO: pivot/update txtr, update screen (NON-BLOCKING)?
 //make frbuf available for next round of frames:
 //CAUTION: potential race condition, but render wkers should be far enough ahead that it doesn't matter:
-                it->ready.store(0);
-//                it->prevfr.store(it->frnum.load());
-                it->frnum += SIZEOF(m_fbque); //tell wkers which frame to render next;//QUELEN; //NOTE: do this last (wkers look for this)
+                recycle(it);
 //                m_frctl.numfr = frnum; //pre-inc
 //kludge: try to compensate for first iteration likely had extra startup overhead or had extra time for prep:
 //                if (!frnum) memset(&m_frctl.perf_stats[0], 0, sizeof(m_frctl.perf_stats)); //clear special case values; //TXTR::CALLER] = 0;
@@ -1240,7 +1749,7 @@ public: //methods:
         if (exc_msg.size()) debug(0, RED_MSG "gpu wker exc: %s" << ss.str(), exc_msg.c_str());
         else debug(0, YELLOW_MSG "gpu wker exit" << ss.str());
         strncpy(m_frctl.exc_reason, exc_msg.c_str(), sizeof(m_frctl.exc_reason));
-        m_frctl.protocol = Protocol::CANCEL;
+        if (!m_frctl.supervised || !exc_msg.size()) m_frctl.protocol = Protocol::CANCEL; //else leave protocol as-is so watchdog can restart
         isopen(false); //m_frctl.isrunning = false;
 //            aoptr->islistening(false); //listener.busy = true; //(void*)1;
 //        aoptr->stop(); //env);
@@ -1275,10 +1784,14 @@ public: //NAPI methods:
         add_prop_uint32(VERSION)(props.emplace_back()); //(*pptr++);
 //        add_prop_uint32(SHMKEY)(props.emplace_back()); //(*pptr++);
         add_prop_uint32(NUM_UNIV)(props.emplace_back()); //(*pptr++);
+        add_prop_uint32("UNIV_BASE", m_frctl.port * NUM_UNIV)(props.emplace_back()); //first univ of this port in combined univ index
+        add_prop_uint32("port", m_frctl.port)(props.emplace_back());
         add_prop_uint32("UNIV_MAXLEN", SIZEOF(m_fbque[0].nodes[0]) /*UNIV_MAXLEN_pad*/)(props.emplace_back()); //give caller actual row len for correct node addressing
 //expose Protocol types (enum consts):
         add_prop("Protocols", Protocol::my_exports(env))(props.emplace_back());
         add_prop("PerfStats", FrameControl::my_exports_perfinx(env))(props.emplace_back());
+        add_prop("Tweens", FrameControl::my_exports_tween(env))(props.emplace_back());
+        add_prop("Sched", FrameControl::my_exports_sched(env))(props.emplace_back());
 //shm data structs:
         add_prop("manifest", /*ManifestType::*/m_manifest.my_exports(env))(props.emplace_back()); //(*pptr++);
 //state getters/setters:
@@ -1315,7 +1828,23 @@ public: //NAPI methods:
 //        !NAPI_OK(napi_define_properties(env, retval, props.size(), props.data()), "export protocol props failed");
 //methods:
         add_method("open", ShmData::Open_NAPI, this)(props.emplace_back()); //(*pptr++);
+        add_method("timing", ShmData::Timing_NAPI, this)(props.emplace_back());
+        add_method("setUniverse", ShmData::SetUniverse_NAPI, this)(props.emplace_back());
+        add_method("fillRange", ShmData::FillRange_NAPI, this)(props.emplace_back());
+        add_method("writeFrame", ShmData::WriteFrame_NAPI, this)(props.emplace_back());
+        add_method("addEffect", ShmData::AddEffect_NAPI, this)(props.emplace_back());
+        add_method("removeEffect", ShmData::RemoveEffect_NAPI, this)(props.emplace_back());
+        add_method("renderEffects", ShmData::RenderEffects_NAPI, this)(props.emplace_back());
+        add_method("layerStats", ShmData::LayerStats_NAPI, this)(props.emplace_back());
+        add_method("setMapping", ShmData::SetMapping_NAPI, this)(props.emplace_back());
+        add_method("mapFrame", ShmData::MapFrame_NAPI, this)(props.emplace_back());
+        add_method("startPool", ShmData::StartPool_NAPI, this)(props.emplace_back());
+        add_method("stopPool", ShmData::StopPool_NAPI, this)(props.emplace_back());
         add_method("close", ShmData::Close_NAPI, this)(props.emplace_back()); //(*pptr++);
+        add_method("openAsync", ShmData::OpenAsync_NAPI, this)(props.emplace_back());
+        add_method("closeAsync", ShmData::CloseAsync_NAPI, this)(props.emplace_back());
+        add_method("nextFrame", ShmData::NextFrame_NAPI, this)(props.emplace_back());
+        add_method("waitFrame", ShmData::WaitFrame_NAPI, this)(props.emplace_back());
 //        napi_thingy more_retval(env, retval);
 //        more_retval += props;
 //        return more_retval;
@@ -1334,9 +1863,8 @@ public: //NAPI methods:
         size_t argc = SIZEOF(argv);
 //    !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, NULL, NULL), "Arg parse failed");
         !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
-        if (argc > 1) NAPI_exc("expected 0-1 opts arg, got " << argc << " args");
+        if (argc > 1) { NAPI_exc("expected 0-1 opts arg, got " << argc << " args"); return NULL; }
         shmptr->isvalid(env, SRCLINE);
-        if (shmptr->isopen()) NAPI_exc("GPU port is already open");
 //    if (argc < 1) 
 //    napi_status napi_typeof(napi_env env, napi_value value, napi_valuetype* result)
 //    char str[1024];
@@ -1347,10 +1875,18 @@ public: //NAPI methods:
 //        int debug = 33;
         int screen = FIRST_SCREEN;
 //    key_t PREALLOC_shmkey = 0;
-        int vgroup = 1;
+        int vgroup = 0; //0 = let timing solver choose
+        int univlen = 0; //requested #nodes per univ (0 = as many as screen allows)
         Uint32 init_color = BLACK;
         /*Nodebuf::Protocol*/ /*Protocol::base_type*/ auto protocol = Protocol::uncast(Protocol::/*Enum::*/WS281X);
         int frtime_msec = 0; //target frame rate; //double fps;
+        int tween = FrameControl::TWEEN_NONE; //what to do if next frame not ready in time
+        int deadline_msec = 0; //commit partial frame this long before vsync (0 = wait for all univ)
+        int catchup = false; //drop late frames to stay in sync with wall clock
+        int rtpolicy = SCHED_OTHER, rtprio = 0, cpumask = 0, mlock = false; //real-time tuning for gpu wker
+        int pipeline = false; //overlap encode with vsync wait
+        int watchdog = 0; //restart gpu wker after this many frame times without progress
+        int daemon = false; //run gpu wker in its own proc; attach if already running
         bool had_opts = false;
 
 //        napi_thingy opts(env, argv[0]);
@@ -1358,7 +1894,7 @@ public: //NAPI methods:
         {
             uint32_t listlen;
             napi_value proplist;
-            if (valtype(env, argv[0]) != napi_object) NAPI_exc("First arg not object"); //TODO: allow other types?
+            if (valtype(env, argv[0]) != napi_object) { NAPI_exc("First arg not object"); return NULL; } //TODO: allow other types?
             !NAPI_OK(napi_get_property_names(env, argv[0], &proplist), "Get prop names failed");
             !NAPI_OK(napi_get_array_length(env, proplist, &listlen), "Get array len failed");
 //#if 1
@@ -1372,9 +1908,20 @@ public: //NAPI methods:
 //                {"debug", &debug},
                 {"screen", &screen},
                 {"vgroup", &vgroup},
+                {"univlen", &univlen},
                 {"init_color", (int*)&init_color},
                 {"protocol", &protocol},
                 {"frtime_msec", &frtime_msec},
+                {"tween", &tween},
+                {"deadline_msec", &deadline_msec},
+                {"catchup", &catchup},
+                {"rtpolicy", &rtpolicy},
+                {"rtprio", &rtprio},
+                {"cpumask", &cpumask},
+                {"mlockall", &mlock},
+                {"pipeline", &pipeline},
+                {"watchdog", &watchdog},
+                {"daemon", &daemon},
             };
 //            std::function<int(KEYTYPE key)> find = [known_opts](KEYTYPE key) -> std::pair<KEYTYPE, int*>*
 //            {
@@ -1419,37 +1966,620 @@ public: //NAPI methods:
 //            m_opts.protocol = static_cast<Nodebuf::Protocol>(prtemp);
 //        if (islistening()) debug(RED_MSG "TODO: check for arg mismatch" ENDCOLOR);
         }
-        debug(17, "open opts: explicit? %d, screen %d, vgroup %d, init_color 0x%x, protocol %d (%s), frtime_msec %d", had_opts, screen, vgroup, init_color, protocol, Protocol(protocol).toString(), frtime_msec); //, debug);
-//internal state:
-//        static const Nodebuf::TXTR* PBEOF = (Nodebuf::TXTR*)-5;
-//        napi_threadsafe_function fats; //asynchronous thread-safe JavaScript call-back function; can be called from any thread
-//        Nodebuf::TXTR::REFILL refill; //void (*m_refill)(Nodebuf::TXTR*); //void* (*REFILL)(mySDL_AutoTexture* txtr); //void);
-//to "open" gpu port, start up bkg wker:
-//??        init_fbque(); //do this before returning to caller
-        shmptr->m_frctl.protocol = protocol; //this one is under caller control and passed via shm
-//        void gpu_wker(int NUMFR = INT_MAX, int screen = FIRST_SCREEN, SDL_Size* want_wh = NO_SIZE, size_t vgroup = 1, NODEVAL init_color = BLACK, SrcLine srcline = 0)
-//        uint32_t ref_count;
-//        !NAPI_OK(napi_reference_ref(env, shmptr->ref, &ref_count), "Inc ref count failed");
-        std::thread bkg(gpu_wker_static, shmptr, INT_MAX, screen, NO_SIZE, vgroup, init_color, &SRCLINE[0]);
-//      try {} catch {}
-        bkg.detach();
-#if 0
-    Uint32 color; //= BLACK;
-    napi_value num_arg;
-    !NAPI_OK(napi_coerce_to_number(env, argv[0], &num_arg), "Get arg as num failed");
-    !NAPI_OK(napi_get_value_uint32(env, num_arg, &color), "Get uint32 colo failed");
-//    using LIMIT = limit<pct(50/60)>; //limit brightness to 83% (50 mA/pixel instead of 60 mA); gives 15A/300 pixels, which is a good safety factor for 20A power supplies
-//actual work done here; surrounding code is overhead :(
-    color = limit<ShmData::BRIGHTEST>(color); //83% //= 3 * 212, //0xD4D4D4, //limit R+G+B value; helps reduce power usage; 212/255 ~= 83% gives 50 mA per node instead of 60 mA
-//    napi_value retval;
-//    !NAPI_OK(napi_create_uint32(env, color, &retval), "Cre retval failed");
-//    return retval;
-    return napi_thingy(env, color);
-#endif
-//        napi_thingy retval(env, thrinx(bkg.get_id()));
-//        return NULL;
-//        return retval;
-        return napi_thingy(env, LogInfo::thrinx_static(bkg.get_id()), napi_thingy::Int32{});
+        debug(17, "open opts: explicit? %d, screen %d, vgroup %d, init_color 0x%x, protocol %d (%s), frtime_msec %d, tween %d", had_opts, screen, vgroup, init_color, protocol, Protocol(protocol).toString(), frtime_msec, tween); //, debug);
+        bool failed; //bad opt; don't touch shm
+        !NAPI_OK(napi_is_exception_pending(env, &failed), "Check exc pending failed");
+        if (failed) return NULL;
+        const int32_t owner = shmptr->m_frctl.owner;
+        if ((shmptr->isopen() || shmptr->m_frctl.supervised) && owner && kill(owner, 0) && (errno == ESRCH)) //proc running gpu wker died without cleanup; reclaim port
+        {
+            debug(12, YELLOW_MSG "reclaim port from dead proc %d", owner);
+            shmptr->m_frctl.supervised = false;
+            shmptr->m_frctl.daemon = 0;
+            shmptr->isopen(false);
+        }
+        if (shmptr->isopen() || shmptr->m_frctl.supervised)
+        {
+            if (daemon && shmptr->m_frctl.daemon) return napi_thingy(env, shmptr->m_frctl.daemon, napi_thingy::Int32{}); //attach; daemon's settings stay in effect
+            NAPI_exc("GPU port is already open");
+            return NULL;
+        }
+        if ((tween < FrameControl::TWEEN_NONE) || (tween > FrameControl::TWEEN_BLEND)) { NAPI_exc("unknown tween mode: " << tween); return NULL; }
+        if (deadline_msec < 0) { NAPI_exc("invalid deadline: " << deadline_msec << " msec"); return NULL; }
+        if (watchdog < 0) { NAPI_exc("invalid watchdog: " << watchdog << " frames"); return NULL; }
+        if (rtprio && (rtpolicy == SCHED_OTHER)) rtpolicy = SCHED_FIFO; //priority implies real-time
+        if ((vgroup < 0) || (univlen < 0)) { NAPI_exc("invalid vgroup " << vgroup << " or univlen " << univlen); return NULL; }
+        if ((rtpolicy != SCHED_OTHER) && (rtpolicy != SCHED_FIFO) && (rtpolicy != SCHED_RR)) { NAPI_exc("unknown sched policy: " << rtpolicy); return NULL; }
+        const Timing timing = solve_timing(screen, univlen, frtime_msec? 1000.0 / frtime_msec: 0, vgroup, SRCLINE);
+        vgroup = timing.vgroup;
+        snprintf(shmptr->m_frctl.timing, sizeof(shmptr->m_frctl.timing), "vgroup %d, univ len %d, %4.2f fps, bit %4.3f usec: %s", timing.vgroup, std::min(timing.univlen, timing.maxlen), timing.fps, timing.bit_usec, timing.why);
+        if (!timing.ok && (protocol == Protocol::WS281X)) exc_soft("screen %d timing: %s", screen, timing.why); //still open; dev screens won't meet WS281X timing
+//internal state:
+//        static const Nodebuf::TXTR* PBEOF = (Nodebuf::TXTR*)-5;
+//        napi_threadsafe_function fats; //asynchronous thread-safe JavaScript call-back function; can be called from any thread
+//        Nodebuf::TXTR::REFILL refill; //void (*m_refill)(Nodebuf::TXTR*); //void* (*REFILL)(mySDL_AutoTexture* txtr); //void);
+//to "open" gpu port, start up bkg wker:
+//??        init_fbque(); //do this before returning to caller
+        shmptr->m_frctl.protocol = protocol; //this one is under caller control and passed via shm
+        shmptr->m_frctl.tween = tween;
+        shmptr->m_frctl.deadline_msec = deadline_msec;
+        shmptr->m_frctl.catchup = catchup;
+        shmptr->m_frctl.rtpolicy = rtpolicy;
+        shmptr->m_frctl.rtprio = rtprio;
+        shmptr->m_frctl.cpumask = cpumask;
+        shmptr->m_frctl.mlock = mlock;
+        shmptr->m_frctl.pipeline = pipeline;
+        shmptr->m_frctl.watchdog = watchdog;
+        shmptr->m_frctl.supervised = (watchdog > 0); //before wker starts; watchdog might not be running yet if wker dies right away
+        shmptr->m_frctl.exc_reason[0] = '\0';
+        if (daemon) return napi_thingy(env, shmptr->daemonize(screen, vgroup, init_color, SRCLINE), napi_thingy::Int32{}); //no SDL/window in this proc
+//        void gpu_wker(int NUMFR = INT_MAX, int screen = FIRST_SCREEN, SDL_Size* want_wh = NO_SIZE, size_t vgroup = 1, NODEVAL init_color = BLACK, SrcLine srcline = 0)
+//        uint32_t ref_count;
+//        !NAPI_OK(napi_reference_ref(env, shmptr->ref, &ref_count), "Inc ref count failed");
+        std::thread bkg(gpu_wker_static, shmptr, INT_MAX, screen, NO_SIZE, vgroup, init_color, false, &SRCLINE[0]);
+//      try {} catch {}
+        bkg.detach();
+        if (watchdog) std::thread(watchdog_static, shmptr, screen, vgroup, init_color, &SRCLINE[0]).detach();
+#if 0
+    Uint32 color; //= BLACK;
+    napi_value num_arg;
+    !NAPI_OK(napi_coerce_to_number(env, argv[0], &num_arg), "Get arg as num failed");
+    !NAPI_OK(napi_get_value_uint32(env, num_arg, &color), "Get uint32 colo failed");
+//    using LIMIT = limit<pct(50/60)>; //limit brightness to 83% (50 mA/pixel instead of 60 mA); gives 15A/300 pixels, which is a good safety factor for 20A power supplies
+//actual work done here; surrounding code is overhead :(
+    color = limit<ShmData::BRIGHTEST>(color); //83% //= 3 * 212, //0xD4D4D4, //limit R+G+B value; helps reduce power usage; 212/255 ~= 83% gives 50 mA per node instead of 60 mA
+//    napi_value retval;
+//    !NAPI_OK(napi_create_uint32(env, color, &retval), "Cre retval failed");
+//    return retval;
+    return napi_thingy(env, color);
+#endif
+//        napi_thingy retval(env, thrinx(bkg.get_id()));
+//        return NULL;
+//        return retval;
+        return napi_thingy(env, LogInfo::thrinx_static(bkg.get_id()), napi_thingy::Int32{});
+    }
+//run timing solver without opening port:
+    static napi_value Timing_NAPI(napi_env env, napi_callback_info info)
+    {
+        if (!env) return NULL; //Node cleanup mode?
+        DebugInOut("Timing_napi");
+
+        napi_value argv[1+1], This; //allow 1 extra arg to check for extras
+        size_t argc = SIZEOF(argv);
+        !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, NULL), "Get cb info failed");
+        if (argc > 1) NAPI_exc("expected 0-1 opts arg, got " << argc << " args");
+        int screen = FIRST_SCREEN, univlen = 0, vgroup = 0;
+        double fps = 0;
+        if (argc && (valtype(env, argv[0]) != napi_undefined))
+        {
+            if (valtype(env, argv[0]) != napi_object) NAPI_exc("First arg not object");
+            static const str_map<const char*, int*> known_opts = {{"screen", &screen}, {"univlen", &univlen}, {"vgroup", &vgroup}};
+            uint32_t listlen;
+            napi_value proplist;
+            !NAPI_OK(napi_get_property_names(env, argv[0], &proplist), "Get prop names failed");
+            !NAPI_OK(napi_get_array_length(env, proplist, &listlen), "Get array len failed");
+            for (int i = 0; i < listlen; ++i)
+            {
+                napi_thingy propname(env), propval(env);
+                !NAPI_OK(napi_get_element(env, proplist, i, &propname.value), "Get array element failed");
+                const std::string& buf = propname.as_str(true);
+                !NAPI_OK(napi_get_named_property(env, argv[0], buf.c_str(), &propval.value), "Get named prop failed");
+                if (buf == "fps") fps = propval.as_float(true);
+                else if (!known_opts.find(buf.c_str())) NAPI_exc("unrecognized option: " << buf << " " << propval);
+                else *known_opts.find(buf.c_str())->second = propval.as_int32(true);
+            }
+        }
+        const Timing timing = solve_timing(screen, univlen, fps, vgroup, SRCLINE);
+        napi_thingy retval(env, napi_thingy::Object{});
+        vector_cxx17<my_napi_property_descriptor> props;
+        add_prop("screen", napi_thingy(env, timing.screen, napi_thingy::Int32{}))(props.emplace_back());
+        add_prop("vgroup", napi_thingy(env, timing.vgroup, napi_thingy::Int32{}))(props.emplace_back());
+        add_prop("univlen", napi_thingy(env, timing.univlen, napi_thingy::Int32{}))(props.emplace_back());
+        add_prop("maxlen", napi_thingy(env, timing.maxlen, napi_thingy::Int32{}))(props.emplace_back());
+        add_prop("fps", napi_thingy(env, timing.fps, napi_thingy::Float{}))(props.emplace_back());
+        add_prop("row_usec", napi_thingy(env, timing.row_usec, napi_thingy::Float{}))(props.emplace_back());
+        add_prop("bit_usec", napi_thingy(env, timing.bit_usec, napi_thingy::Float{}))(props.emplace_back());
+        add_prop("hblank_usec", napi_thingy(env, timing.hblank_usec, napi_thingy::Float{}))(props.emplace_back());
+        add_prop("vblank_usec", napi_thingy(env, timing.vblank_usec, napi_thingy::Float{}))(props.emplace_back());
+        add_prop("ok", napi_thingy(env, timing.ok, napi_thingy::Boolean{}))(props.emplace_back());
+        add_prop("why", napi_thingy(env, timing.why))(props.emplace_back());
+        retval += props;
+        return retval;
+    }
+//bulk node writes; one JS -> C++ call per univ instead of per node:
+//setUniverse(qent, univ, Uint32Array[, ofs[, ready]]) copies colors to nodebufs[qent].nodes[univ][ofs..]
+//fillRange(qent, univ, color[, ofs[, count[, ready]]]) fills rest of univ (or count nodes) with one color
+//both apply brightness limit and set univ ready bit unless ready arg is false; returns #nodes written
+    static napi_value SetUniverse_NAPI(napi_env env, napi_callback_info info) { return Bulk_NAPI(env, info, false); }
+    static napi_value FillRange_NAPI(napi_env env, napi_callback_info info) { return Bulk_NAPI(env, info, true); }
+    static napi_value Bulk_NAPI(napi_env env, napi_callback_info info, bool fill)
+    {
+        if (!env) return NULL; //Node cleanup mode?
+//        DebugInOut("Bulk_napi"); //too verbose; called for every univ every frame
+
+        ShmData* shmptr;
+        napi_value argv[6+1], This; //allow 1 extra arg to check for extras
+        size_t argc = SIZEOF(argv);
+        !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+        const size_t readyarg = fill? 5: 4; //optional last arg
+        if ((argc < 3) || (argc > readyarg + 1)) { NAPI_exc("expected 3.." << (readyarg + 1) << " args (qent, univ, " << (fill? "color": "Uint32Array") << ", ...), got " << argc << " arg" << plural(argc)); return NULL; }
+        shmptr->isvalid(env, SRCLINE);
+        const int qent = napi_thingy(env, argv[0]).as_int32(true), univ = napi_thingy(env, argv[1]).as_int32(true);
+        const int ofs = (argc > 3)? napi_thingy(env, argv[3]).as_int32(true): 0;
+        if ((qent < 0) || (qent >= SIZEOF(shmptr->m_fbque))) { NAPI_exc("invalid qent: " << qent << " (expected 0.." << (SIZEOF(shmptr->m_fbque) - 1) << ")"); return NULL; }
+        if ((univ < 0) || (univ >= NUM_UNIV)) { NAPI_exc("invalid univ: " << univ << " (expected 0.." << (NUM_UNIV - 1) << ")"); return NULL; }
+        FramebufQuent& fbquent = shmptr->m_fbque[qent];
+        const int univlen = SIZEOF(fbquent.nodes[univ]);
+        if ((ofs < 0) || (ofs > univlen)) { NAPI_exc("invalid ofs: " << ofs << " (univ len " << univlen << ")"); return NULL; }
+        int count = univlen - ofs;
+        if (fill)
+        {
+            if (argc > 4) count = std::min(count, std::max(napi_thingy(env, argv[4]).as_int32(true), 0)); //clip to univ
+            limit_fill(&fbquent.nodes[univ][ofs], napi_thingy(env, argv[2]).as_uint32(true), count);
+        }
+        else
+        {
+            void* data;
+            napi_value arybuf;
+            size_t arylen, bofs;
+            napi_typedarray_type arytype;
+            if (!napi_thingy(env, argv[2]).istypary()) { NAPI_exc("expected Uint32Array, got " << napi_thingy(env, argv[2])); return NULL; }
+            !NAPI_OK(napi_get_typedarray_info(env, argv[2], &arytype, &arylen, &data, &arybuf, &bofs), "Get typed array info failed");
+            if ((arytype != napi_uint32_array) && (arytype != napi_int32_array)) { NAPI_exc("expected Uint32Array, got typed array type " << arytype); return NULL; }
+            if (arylen > count) { NAPI_exc(arylen << " colors at ofs " << ofs << " overruns univ len " << univlen); return NULL; }
+            count = arylen;
+            limit_copy(&fbquent.nodes[univ][ofs], static_cast<const NODEVAL*>(data), count);
+        }
+        if ((argc <= readyarg) || napi_thingy(env, argv[readyarg]).as_int32(true)) fbquent.ready |= univ_bit(univ); //NOTE: caller should check frnum first (see README)
+        return napi_thingy(env, count, napi_thingy::Int32{});
+    }
+//frame writes for streams; copies a whole frame (or a slice of consecutive univ) into the slot for fr#:
+//writeFrame(frnum, Uint32Array[, univ[, univlen]]) copies univlen (default UNIV_LEN) nodes per univ, starting at univ (default 0)
+//returns #univ written, 0 if slot is still in use by an earlier frame (try again after nextFrame(frnum - QUELEN)), or -1 if fr# was already consumed or dropped
+    static napi_value WriteFrame_NAPI(napi_env env, napi_callback_info info)
+    {
+        if (!env) return NULL; //Node cleanup mode?
+//        DebugInOut("WriteFrame_napi"); //called every frame
+
+        ShmData* shmptr;
+        napi_value argv[4+1], This; //allow 1 extra arg to check for extras
+        size_t argc = SIZEOF(argv);
+        !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+        if ((argc < 2) || (argc > 4)) { NAPI_exc("expected 2-4 args: fr#, Uint32Array, [univ], [univ len], got " << argc << " arg" << plural(argc)); return NULL; }
+        shmptr->isvalid(env, SRCLINE);
+        const int32_t frnum = napi_thingy(env, argv[0]).as_int32(true);
+        const int univ = (argc > 2)? napi_thingy(env, argv[2]).as_int32(true): 0;
+        const int univlen = (argc > 3)? napi_thingy(env, argv[3]).as_int32(true): shmptr->m_frctl.wh.h;
+        if ((univ < 0) || (univ >= NUM_UNIV)) { NAPI_exc("invalid univ: " << univ << " (expected 0.." << (NUM_UNIV - 1) << ")"); return NULL; }
+        if ((univlen <= 0) || (univlen > SIZEOF(shmptr->m_fbque[0].nodes[0]))) { NAPI_exc("invalid univ len: " << univlen << " (max " << SIZEOF(shmptr->m_fbque[0].nodes[0]) << ")"); return NULL; }
+        void* data;
+        napi_value arybuf;
+        size_t arylen, bofs;
+        napi_typedarray_type arytype;
+        if (!napi_thingy(env, argv[1]).istypary()) { NAPI_exc("expected Uint32Array, got " << napi_thingy(env, argv[1])); return NULL; }
+        !NAPI_OK(napi_get_typedarray_info(env, argv[1], &arytype, &arylen, &data, &arybuf, &bofs), "Get typed array info failed");
+        if ((arytype != napi_uint32_array) && (arytype != napi_int32_array)) { NAPI_exc("expected Uint32Array, got typed array type " << arytype); return NULL; }
+        const int numuniv = divup(arylen, univlen); //last univ can be short
+        if (!arylen || (univ + numuniv > NUM_UNIV)) { NAPI_exc(arylen << " colors starting at univ " << univ << " is not 1.." << (NUM_UNIV - univ) << " univ of " << univlen << " nodes"); return NULL; }
+        FramebufQuent& fbquent = shmptr->m_fbque[(uint32_t)frnum % SIZEOF(shmptr->m_fbque)];
+        const int32_t slotfr = fbquent.frnum.load();
+        if (slotfr != frnum) return napi_thingy(env, ((int32_t)(frnum - slotfr) > 0)? 0: -1, napi_thingy::Int32{}); //not recycled yet, or too late
+        const NODEVAL* src = static_cast<const NODEVAL*>(data);
+        MASK_TYPE bits = 0;
+        for (int x = 0; x < numuniv; ++x, src += univlen)
+        {
+            limit_copy(&fbquent.nodes[univ + x][0], src, std::min<size_t>(univlen, arylen - x * univlen));
+            bits |= univ_bit(univ + x);
+        }
+        if (fbquent.frnum.load() != frnum) return napi_thingy(env, -1, napi_thingy::Int32{}); //partial/dropped frame recycled while copying; don't set bits on later frame
+        fbquent.ready |= bits; //commit all univ at once
+        return napi_thingy(env, numuniv, napi_thingy::Int32{});
+    }
+//native effects (cues):
+//JS adds effects once per cue; renderEffects(qent) then renders all of them into a frame buffer slot for that slot's fr#
+//effects are layers: composited bottom to top (add order) with their own blend mode and opacity
+//NOTE: like listeners, effects are process-local (params are small; each render proc/thread adds its own)
+    struct Layer
+    {
+        const Effect fx;
+        std::atomic<uint32_t> numrender, last_usec; //cost accounting; atomic because pool threads render univ in parallel
+        std::atomic<uint64_t> total_usec;
+        explicit Layer(const Effect& new_fx): fx(new_fx), numrender(0), last_usec(0), total_usec(0) {}
+    };
+    typedef std::vector<std::shared_ptr<Layer>> LayerList;
+    struct EffectList
+    {
+        std::mutex mtx;
+        std::map<int, std::shared_ptr<Layer>> list; //by id; ids only increase, so this is also add (layer) order
+        int nextid = 1;
+//copy of current layers so renderers don't hold the lock (or see add/remove) while rendering a frame:
+        std::shared_ptr<const LayerList> snapshot()
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            std::shared_ptr<LayerList> layers = std::make_shared<LayerList>();
+            for (const auto& it: list) layers->push_back(it.second);
+            return layers;
+        }
+    };
+    static EffectList& effects(int port = 0) { static EffectList m_effects[MAX_PORTS]; return m_effects[port]; } //kludge: avoid static member decl at global scope
+//addEffect({type, univ, ofs, count, color, color2, start, period, speed, density, seed, blend, opacity}) returns effect id:
+    static napi_value AddEffect_NAPI(napi_env env, napi_callback_info info)
+    {
+        if (!env) return NULL; //Node cleanup mode?
+        DebugInOut("AddEffect_napi");
+
+        ShmData* shmptr;
+        napi_value argv[1+1], This; //allow 1 extra arg to check for extras
+        size_t argc = SIZEOF(argv);
+        !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+        if ((argc != 1) || (valtype(env, argv[0]) != napi_object)) NAPI_exc("expected 1 arg: {type, univ, ...}, got " << argc << " arg" << plural(argc));
+        shmptr->isvalid(env, SRCLINE);
+        Effect fx;
+        fx.start = shmptr->m_frctl.numfr; //cue starts now unless caller says otherwise
+        const str_map<const char*, int*> known_opts =
+        {
+            {"univ", &fx.univ},
+            {"ofs", &fx.ofs},
+            {"count", &fx.count},
+            {"color", (int*)&fx.color},
+            {"color2", (int*)&fx.color2},
+            {"start", &fx.start},
+            {"period", &fx.period},
+            {"seed", (int*)&fx.seed},
+        };
+        uint32_t listlen;
+        napi_value proplist;
+        !NAPI_OK(napi_get_property_names(env, argv[0], &proplist), "Get prop names failed");
+        !NAPI_OK(napi_get_array_length(env, proplist, &listlen), "Get array len failed");
+        for (int i = 0; i < listlen; ++i)
+        {
+            napi_thingy propname(env), propval(env);
+            !NAPI_OK(napi_get_element(env, proplist, i, &propname.value), "Get array element failed");
+            const std::string& buf = propname.as_str(true);
+            const char* namebuf = buf.c_str();
+            !NAPI_OK(napi_get_named_property(env, argv[0], namebuf, &propval.value), "Get named prop failed");
+            if (!strcmp(namebuf, "type")) fx.kind = Effect::kind_of(propval.as_str(true).c_str());
+            else if (!strcmp(namebuf, "speed")) fx.speed = propval.as_float(true); //kludge: float not handled by known_opts table
+            else if (!strcmp(namebuf, "density")) fx.density = propval.as_float(true);
+            else if (!strcmp(namebuf, "opacity")) fx.opacity = propval.as_float(true);
+            else if (!strcmp(namebuf, "blend")) fx.blend = Effect::blend_of(propval.as_str(true).c_str());
+            else if (!known_opts.find(namebuf)) NAPI_exc("unrecognized option: " << namebuf << " " << propval);
+            else *known_opts.find(namebuf)->second = propval.as_int32(true);
+        }
+        if (fx.kind <= Effect::NONE) NAPI_exc("unknown effect type; expected fill, gradient, chase, twinkle, fade, wipe, rainbow or sparkle");
+        if (fx.blend < 0) NAPI_exc("unknown blend mode; expected normal, add, max, multiply or alpha");
+        if ((fx.univ < 0) || (fx.univ >= NUM_UNIV)) NAPI_exc("invalid univ: " << fx.univ << " (expected 0.." << (NUM_UNIV - 1) << ")");
+        if ((fx.ofs < 0) || (fx.count < 0) || (fx.ofs + fx.count > SIZEOF(shmptr->m_fbque[0].nodes[0]))) NAPI_exc("invalid node range: " << fx.ofs << "+" << fx.count << " (univ len " << SIZEOF(shmptr->m_fbque[0].nodes[0]) << ")");
+        bool failed;
+        !NAPI_OK(napi_is_exception_pending(env, &failed), "Check exc pending failed");
+        if (failed) return NULL;
+        EffectList& fxlist = effects(shmptr->m_frctl.port);
+        std::lock_guard<std::mutex> lock(fxlist.mtx);
+        const int id = fxlist.nextid++;
+        fxlist.list[id] = std::make_shared<Layer>(fx);
+        debug(12, "add effect[%d] " << fx, id);
+        return napi_thingy(env, id, napi_thingy::Int32{});
+    }
+//removeEffect([id]) removes one effect (or all); returns #removed:
+    static napi_value RemoveEffect_NAPI(napi_env env, napi_callback_info info)
+    {
+        if (!env) return NULL; //Node cleanup mode?
+        DebugInOut("RemoveEffect_napi");
+
+        ShmData* shmptr;
+        napi_value argv[1+1], This; //allow 1 extra arg to check for extras
+        size_t argc = SIZEOF(argv);
+        !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+        if (argc > 1) { NAPI_exc("expected 0-1 args: [effect id], got " << argc << " args"); return NULL; }
+        shmptr->isvalid(env, SRCLINE);
+        EffectList& fxlist = effects(shmptr->m_frctl.port);
+        std::lock_guard<std::mutex> lock(fxlist.mtx);
+        int count = fxlist.list.size();
+        if (argc) count = fxlist.list.erase(napi_thingy(env, argv[0]).as_int32(true));
+        else fxlist.list.clear(); //no arg = remove all
+        return napi_thingy(env, count, napi_thingy::Int32{});
+    }
+//renderEffects(qent[, ready]) renders all effects into nodebufs[qent] for its fr#; sets ready bits for univ touched unless ready is false
+//returns ready bits for univ touched (0 if slot was recycled while rendering)
+    static napi_value RenderEffects_NAPI(napi_env env, napi_callback_info info)
+    {
+        if (!env) return NULL; //Node cleanup mode?
+//        DebugInOut("RenderEffects_napi"); //called every frame
+
+        ShmData* shmptr;
+        napi_value argv[2+1], This; //allow 1 extra arg to check for extras
+        size_t argc = SIZEOF(argv);
+        !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+        if ((argc < 1) || (argc > 2)) { NAPI_exc("expected 1-2 args: qent, [ready], got " << argc << " arg" << plural(argc)); return NULL; }
+        shmptr->isvalid(env, SRCLINE);
+        const int qent = napi_thingy(env, argv[0]).as_int32(true);
+        if ((qent < 0) || (qent >= SIZEOF(shmptr->m_fbque))) { NAPI_exc("invalid qent: " << qent << " (expected 0.." << (SIZEOF(shmptr->m_fbque) - 1) << ")"); return NULL; }
+        FramebufQuent& fbquent = shmptr->m_fbque[qent];
+        const int32_t frnum = fbquent.frnum.load();
+        const MASK_TYPE bits = render_effects(fbquent, frnum);
+        if (fbquent.frnum.load() != frnum) return napi_thingy(env, 0, napi_thingy::Uint32{}); //recycled while rendering; don't set bits on later frame
+        if ((argc < 2) || napi_thingy(env, argv[1]).as_int32(true)) fbquent.ready |= bits;
+        return napi_thingy(env, bits, napi_thingy::Uint32{});
+    }
+//pixel mapping:
+//renderers draw into a model-space Uint32Array (matrix, shape, etc); mapFrame() scatters it into univ/node order using runs (see pixmap.h)
+//NOTE: like effects, mapping is process-local; each render proc/thread loads the layout it uses
+    struct PixelMapping
+    {
+        std::mutex mtx;
+        PixelMap map;
+    };
+    static PixelMapping& pixmaps(int port = 0) { static PixelMapping m_pixmaps[MAX_PORTS]; return m_pixmaps[port]; } //kludge: avoid static member decl at global scope
+//setMapping(Int32Array table) or setMapping("layout file"); table[pixel] = univ * 0x10000 + node, -1 = not mapped
+//returns #model pixels needed
+    static napi_value SetMapping_NAPI(napi_env env, napi_callback_info info)
+    {
+        if (!env) return NULL; //Node cleanup mode?
+        DebugInOut("SetMapping_napi");
+
+        ShmData* shmptr;
+        napi_value argv[1+1], This; //allow 1 extra arg to check for extras
+        size_t argc = SIZEOF(argv);
+        !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+        if (argc != 1) { NAPI_exc("expected 1 arg: Int32Array or layout file, got " << argc << " arg" << plural(argc)); return NULL; }
+        shmptr->isvalid(env, SRCLINE);
+        PixelMap newmap;
+        if (valtype(env, argv[0]) == napi_string)
+        {
+            const std::string errmsg = newmap.load(napi_thingy(env, argv[0]).as_str(true).c_str());
+            if (!errmsg.empty()) { NAPI_exc(errmsg); return NULL; }
+        }
+        else
+        {
+            void* data;
+            napi_value arybuf;
+            size_t arylen, bofs;
+            napi_typedarray_type arytype;
+            if (!napi_thingy(env, argv[0]).istypary()) { NAPI_exc("expected Int32Array or layout file, got " << napi_thingy(env, argv[0])); return NULL; }
+            !NAPI_OK(napi_get_typedarray_info(env, argv[0], &arytype, &arylen, &data, &arybuf, &bofs), "Get typed array info failed");
+            if (arytype != napi_int32_array) { NAPI_exc("expected Int32Array, got typed array type " << arytype); return NULL; }
+            newmap.build(static_cast<const int32_t*>(data), arylen);
+        }
+        const int bad = newmap.check(NUM_UNIV, SIZEOF(shmptr->m_fbque[0].nodes[0]));
+        if (bad >= 0) { NAPI_exc("mapping run " << bad << " (univ " << newmap.runs[bad].univ << ", nodes " << newmap.runs[bad].node << "+" << newmap.runs[bad].count << ") is outside node buffer"); return NULL; }
+        PixelMapping& pixmap = pixmaps(shmptr->m_frctl.port);
+        std::lock_guard<std::mutex> lock(pixmap.mtx);
+        pixmap.map = std::move(newmap);
+        debug(12, "pixel map: %d runs, %d pixels", pixmap.map.runs.size(), pixmap.map.numpixels);
+        return napi_thingy(env, pixmap.map.numpixels, napi_thingy::Int32{});
+    }
+//mapFrame(qent, Uint32Array model[, ready]) copies model pixels into nodebufs[qent] (brightness limited); sets ready bits for univ touched unless ready is false
+//returns ready bits for univ touched (0 if slot was recycled while copying)
+    static napi_value MapFrame_NAPI(napi_env env, napi_callback_info info)
+    {
+        if (!env) return NULL; //Node cleanup mode?
+//        DebugInOut("MapFrame_napi"); //called every frame
+
+        ShmData* shmptr;
+        napi_value argv[3+1], This; //allow 1 extra arg to check for extras
+        size_t argc = SIZEOF(argv);
+        !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+        if ((argc < 2) || (argc > 3)) { NAPI_exc("expected 2-3 args: qent, Uint32Array, [ready], got " << argc << " arg" << plural(argc)); return NULL; }
+        shmptr->isvalid(env, SRCLINE);
+        const int qent = napi_thingy(env, argv[0]).as_int32(true);
+        if ((qent < 0) || (qent >= SIZEOF(shmptr->m_fbque))) { NAPI_exc("invalid qent: " << qent << " (expected 0.." << (SIZEOF(shmptr->m_fbque) - 1) << ")"); return NULL; }
+        void* data;
+        napi_value arybuf;
+        size_t arylen, bofs;
+        napi_typedarray_type arytype;
+        if (!napi_thingy(env, argv[1]).istypary()) { NAPI_exc("expected Uint32Array, got " << napi_thingy(env, argv[1])); return NULL; }
+        !NAPI_OK(napi_get_typedarray_info(env, argv[1], &arytype, &arylen, &data, &arybuf, &bofs), "Get typed array info failed");
+        if ((arytype != napi_uint32_array) && (arytype != napi_int32_array)) { NAPI_exc("expected Uint32Array, got typed array type " << arytype); return NULL; }
+        static const LimitLUT limiter(BRIGHTEST);
+        FramebufQuent& fbquent = shmptr->m_fbque[qent];
+        const int32_t frnum = fbquent.frnum.load();
+        const int rowlen = SIZEOF(fbquent.nodes[0]), univlen = shmptr->m_frctl.wh.h? std::min<int>(shmptr->m_frctl.wh.h, rowlen): rowlen;
+        MASK_TYPE bits;
+        {
+            PixelMapping& pixmap = pixmaps(shmptr->m_frctl.port);
+            std::lock_guard<std::mutex> lock(pixmap.mtx);
+            if (arylen < pixmap.map.numpixels) { NAPI_exc("model has " << arylen << " pixels, mapping needs " << pixmap.map.numpixels); return NULL; }
+            bits = pixmap.map.scatter<NODEVAL, MASK_TYPE>(&fbquent.nodes[0][0], rowlen, static_cast<const NODEVAL*>(data), univ_bit);
+        }
+        for (int x = 0; x < NUM_UNIV; ++x)
+            if (bits & univ_bit(x)) limiter(&fbquent.nodes[x][0], univlen);
+        if (fbquent.frnum.load() != frnum) return napi_thingy(env, 0, napi_thingy::Uint32{}); //recycled while copying; don't set bits on later frame
+        if ((argc < 3) || napi_thingy(env, argv[2]).as_int32(true)) fbquent.ready |= bits;
+        return napi_thingy(env, bits, napi_thingy::Uint32{});
+    }
+//layerStats() returns [{id, type, univ, blend, renders, last_usec, avg_usec}] in layer order, to find expensive layers:
+    static napi_value LayerStats_NAPI(napi_env env, napi_callback_info info)
+    {
+        if (!env) return NULL; //Node cleanup mode?
+        DebugInOut("LayerStats_napi");
+
+        ShmData* shmptr;
+        napi_value argv[0+1], This; //allow 1 extra arg to check for extras
+        size_t argc = SIZEOF(argv);
+        !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+        if (argc) NAPI_exc("expected 0 args, got " << argc << " arg" << plural(argc));
+        shmptr->isvalid(env, SRCLINE);
+        EffectList& fxlist = effects(shmptr->m_frctl.port);
+        std::lock_guard<std::mutex> lock(fxlist.mtx);
+        napi_thingy retval(env, napi_thingy::Array{}, fxlist.list.size());
+        int inx = 0;
+        for (const auto& it: fxlist.list)
+        {
+            const Layer& layer = *it.second;
+            napi_thingy stats(env, napi_thingy::Object{});
+            vector_cxx17<my_napi_property_descriptor> props;
+            add_prop("id", napi_thingy(env, it.first, napi_thingy::Int32{}))(props.emplace_back());
+            add_prop("type", napi_thingy(env, Effect::name(layer.fx.kind)))(props.emplace_back());
+            add_prop("univ", napi_thingy(env, layer.fx.univ, napi_thingy::Int32{}))(props.emplace_back());
+            add_prop("blend", napi_thingy(env, Effect::blend_name(layer.fx.blend)))(props.emplace_back());
+            const uint32_t numrender = layer.numrender.load();
+            add_prop("renders", napi_thingy(env, numrender, napi_thingy::Uint32{}))(props.emplace_back());
+            add_prop("last_usec", napi_thingy(env, layer.last_usec.load(), napi_thingy::Uint32{}))(props.emplace_back());
+            add_prop("avg_usec", napi_thingy(env, numrender? (double)layer.total_usec.load() / numrender: 0, napi_thingy::Float{}))(props.emplace_back());
+            stats += props;
+            !NAPI_OK(napi_set_element(env, retval, inx++, stats), "Set layer stats failed");
+        }
+        return retval;
+    }
+//native render pool:
+//pool threads render all layers into each frame buffer slot as soon as gpu wker recycles it; JS doesn't need to call renderEffects()
+//work is split into 1 task per univ; each thread has its own task queue and steals from the others when it runs dry,
+//so an expensive univ only delays itself instead of stalling a whole statically assigned range of univ (as in multi.js)
+//each task sets its own ready bit; utilization is kept in shm (pool_*) so other procs can watch it
+//NOTE: like effects, pool is process-local; threads use the attachment that started them, so pool is stopped before that one detaches
+    struct RenderTask
+    {
+        int qent, univ;
+        int32_t frnum;
+        std::shared_ptr<const LayerList> layers; //snapshot when slot was dispatched; add/removeEffect() applies to later frames
+    };
+    struct RenderPool
+    {
+        struct TaskQueue //work-stealing deque: owner takes newest from back (still in cache), thieves take oldest from front
+        {
+            std::mutex mtx;
+            std::deque<RenderTask> tasks;
+        };
+        std::mutex mtx; //start/stop
+        ShmData* shmptr = NULL;
+        napi_env env = NULL; //env that started pool
+        int numthreads = 0;
+        uint32_t cpumask = 0; //CPU affinity (0 = any)
+        std::vector<std::thread> threads;
+        TaskQueue queues[FrameControl::MAX_POOL];
+        std::atomic<bool> running;
+        std::atomic<int32_t> numqueued; //#tasks not taken yet; idle threads sleep while 0
+        std::mutex dispatch_mtx; //1 thread at a time looks for recycled slots
+        int32_t dispatched[QUELEN]; //fr# already queued for each slot
+        std::mutex idle_mtx;
+        std::condition_variable idle_cv;
+    public: //ctors/dtors
+        RenderPool(): running(false), numqueued(0) {}
+        ~RenderPool() { running = false; for (auto& thr: threads) thr.detach(); } //proc exit without stopPool(); don't std::terminate()
+    public: //methods
+//own queue first, then steal; returns false if all queues are empty:
+        bool take(int id, RenderTask& task, bool& stolen)
+        {
+            for (int i = 0; i < numthreads; ++i)
+            {
+                TaskQueue& que = queues[(id + i) % numthreads];
+                std::lock_guard<std::mutex> lock(que.mtx);
+                if (que.tasks.empty()) continue;
+                if (!i) { task = std::move(que.tasks.back()); que.tasks.pop_back(); }
+                else { task = std::move(que.tasks.front()); que.tasks.pop_front(); }
+                stolen = (i != 0);
+                --numqueued;
+                return true;
+            }
+            return false;
+        }
+    };
+    static RenderPool& pools(int port = 0) { static RenderPool m_pools[MAX_PORTS]; return m_pools[port]; } //kludge: avoid static member decl at global scope
+    static void start_pool(ShmData* shmptr, napi_env env, int numthreads, uint32_t cpumask)
+    {
+        RenderPool& pool = pools(shmptr->m_frctl.port);
+        pool.shmptr = shmptr;
+        pool.env = env;
+        pool.numthreads = numthreads;
+        pool.cpumask = cpumask;
+        for (auto& frnum: pool.dispatched) frnum = -1; //render slots that are already waiting
+        shmptr->m_frctl.pool_tasks = shmptr->m_frctl.pool_steals = 0;
+        memset(&shmptr->m_frctl.pool_util[0], 0, sizeof(shmptr->m_frctl.pool_util));
+        shmptr->m_frctl.pool_threads = numthreads;
+        pool.running = true;
+        for (int i = 0; i < numthreads; ++i) pool.threads.emplace_back(pool_wker, shmptr, i);
+        debug(12, "render pool: port %d, %d threads, cpus 0x%x", shmptr->m_frctl.port, numthreads, cpumask);
+    }
+//caller holds pool.mtx:
+    static void stop_pool(RenderPool& pool)
+    {
+        if (!pool.running) return;
+        pool.running = false;
+        pool.idle_cv.notify_all();
+        for (auto& thr: pool.threads) thr.join();
+        pool.threads.clear();
+        for (auto& que: pool.queues) que.tasks.clear();
+        pool.numqueued = 0;
+        pool.shmptr->m_frctl.pool_threads = 0;
+        pool.shmptr = NULL;
+        pool.env = NULL;
+    }
+//stop pools using this attachment (it's about to detach):
+    static void drop_pools(ShmData* shmptr)
+    {
+        for (int port = 0; port < MAX_PORTS; ++port)
+        {
+            RenderPool& pool = pools(port);
+            std::lock_guard<std::mutex> lock(pool.mtx);
+            if (pool.shmptr == shmptr) stop_pool(pool);
+        }
+    }
+//stop pools started by this env (Node exit or worker_thread exit):
+    static void drop_pools(napi_env env)
+    {
+        for (int port = 0; port < MAX_PORTS; ++port)
+        {
+            RenderPool& pool = pools(port);
+            std::lock_guard<std::mutex> lock(pool.mtx);
+            if (pool.env == env) stop_pool(pool);
+        }
+    }
+//startPool([{threads, cpumask}]) starts native render threads for this port; default is 1 thread per core except 1 (for gpu wker)
+//returns #threads
+    static napi_value StartPool_NAPI(napi_env env, napi_callback_info info)
+    {
+        if (!env) return NULL; //Node cleanup mode?
+        DebugInOut("StartPool_napi");
+
+        ShmData* shmptr;
+        napi_value argv[1+1], This; //allow 1 extra arg to check for extras
+        size_t argc = SIZEOF(argv);
+        !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+        if ((argc > 1) || (argc && (valtype(env, argv[0]) != napi_object))) { NAPI_exc("expected 0-1 args: [{threads, cpumask}], got " << argc << " arg" << plural(argc)); return NULL; }
+        shmptr->isvalid(env, SRCLINE);
+        int numthreads = std::min<int>(std::max<int>(std::thread::hardware_concurrency() - 1, 1), FrameControl::MAX_POOL), cpumask = 0;
+        const str_map<const char*, int*> known_opts =
+        {
+            {"threads", &numthreads},
+            {"cpumask", &cpumask},
+        };
+        uint32_t listlen = 0;
+        napi_value proplist;
+        if (argc) !NAPI_OK(napi_get_property_names(env, argv[0], &proplist), "Get prop names failed");
+        if (argc) !NAPI_OK(napi_get_array_length(env, proplist, &listlen), "Get array len failed");
+        for (int i = 0; i < listlen; ++i)
+        {
+            napi_thingy propname(env), propval(env);
+            !NAPI_OK(napi_get_element(env, proplist, i, &propname.value), "Get array element failed");
+            const std::string& buf = propname.as_str(true);
+            const char* namebuf = buf.c_str();
+            !NAPI_OK(napi_get_named_property(env, argv[0], namebuf, &propval.value), "Get named prop failed");
+            if (!known_opts.find(namebuf)) { NAPI_exc("unrecognized option: " << namebuf << " " << propval); return NULL; }
+            *known_opts.find(namebuf)->second = propval.as_int32(true);
+        }
+        if ((numthreads < 1) || (numthreads > FrameControl::MAX_POOL)) { NAPI_exc("invalid #threads: " << numthreads << " (expected 1.." << FrameControl::MAX_POOL << ")"); return NULL; }
+        RenderPool& pool = pools(shmptr->m_frctl.port);
+        std::lock_guard<std::mutex> lock(pool.mtx);
+        if (pool.running) { NAPI_exc("render pool already running (" << pool.numthreads << " threads); stopPool() first"); return NULL; }
+        start_pool(shmptr, env, numthreads, cpumask);
+        return napi_thingy(env, numthreads, napi_thingy::Int32{});
+    }
+//stopPool() stops native render threads for this port; returns #tasks rendered
+    static napi_value StopPool_NAPI(napi_env env, napi_callback_info info)
+    {
+        if (!env) return NULL; //Node cleanup mode?
+        DebugInOut("StopPool_napi");
+
+        ShmData* shmptr;
+        napi_value argv[0+1], This; //allow 1 extra arg to check for extras
+        size_t argc = SIZEOF(argv);
+        !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+        if (argc) NAPI_exc("expected 0 args, got " << argc << " arg" << plural(argc));
+        shmptr->isvalid(env, SRCLINE);
+        RenderPool& pool = pools(shmptr->m_frctl.port);
+        std::lock_guard<std::mutex> lock(pool.mtx);
+        stop_pool(pool);
+        return napi_thingy(env, shmptr->m_frctl.pool_tasks.load(), napi_thingy::Uint32{});
     }
 //"close" GPU port:
     static napi_value Close_NAPI(napi_env env, napi_callback_info info)
@@ -1464,7 +2594,7 @@ public: //NAPI methods:
         !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
         if (argc) NAPI_exc("expected 0 args, got " << argc << " arg" << plural(argc));
         shmptr->isvalid(env, SRCLINE);
-        if (!shmptr->isopen()) NAPI_exc("GPU port is not already open");
+        if (!shmptr->isopen() && !shmptr->m_frctl.supervised) NAPI_exc("GPU port is not already open"); //watchdog might be restarting it
 //        uint32_t ref_count;
 //        !NAPI_OK(napi_reference_unref(env, shmptr->ref, &ref_count), "Dec ref count failed");
 //    if (argc < 1) 
@@ -1479,6 +2609,68 @@ public: //NAPI methods:
         return napi_thingy(env, shmptr->m_frctl.numfr, napi_thingy::Int32{}); //TODO: what to put here?
 //        return retval;
     }
+//promise variants; resolve with numfr when gpu wker is running/stopped/has consumed a frame, so JS doesn't need polling loops:
+    static napi_value OpenAsync_NAPI(napi_env env, napi_callback_info info) { return Async_NAPI(env, info, FrameControl::WAIT_OPEN); }
+    static napi_value CloseAsync_NAPI(napi_env env, napi_callback_info info) { return Async_NAPI(env, info, FrameControl::WAIT_CLOSE); }
+    static napi_value NextFrame_NAPI(napi_env env, napi_callback_info info) { return Async_NAPI(env, info, FrameControl::WAIT_FRAME); }
+    static napi_value Async_NAPI(napi_env env, napi_callback_info info, int kind)
+    {
+        if (!env) return NULL; //Node cleanup mode?
+        DebugInOut("Async_napi(" << kind << ")");
+
+        ShmData* shmptr;
+        napi_value argv[1+1], This; //allow 1 extra arg to check for extras
+        size_t argc = SIZEOF(argv);
+        !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+        shmptr->isvalid(env, SRCLINE);
+        int32_t frnum = shmptr->m_frctl.numfr; //default = next frame
+        switch (kind)
+        {
+            case FrameControl::WAIT_OPEN: VOID Open_NAPI(env, info); break; //same args as open()
+            case FrameControl::WAIT_CLOSE: VOID Close_NAPI(env, info); break; //same args as close()
+            case FrameControl::WAIT_FRAME:
+                if (argc > 1) NAPI_exc("expected 0-1 args: [fr#], got " << argc << " args");
+                else if (argc && (valtype(env, argv[0]) != napi_undefined)) frnum = napi_thingy(env, argv[0]).as_int32(true);
+                break;
+        }
+        bool failed;
+        !NAPI_OK(napi_is_exception_pending(env, &failed), "Check exc pending failed");
+        if (failed) return NULL; //let caller see exc from open()/close()
+        return FrameControl::wait_async(env, &shmptr->m_frctl, kind, frnum);
+    }
+//blocking wait until gpu wker has consumed fr# (numfr > frnum); for worker_threads or cluster wkers that would otherwise spin or poll:
+//blocks calling thread on a futex over numfr in shm, so it works with gpu wker in any proc; returns numfr (<= frnum if timed out or port stopped)
+//NOTE: JS Atomics.wait() can't be used on shm words (needs a SharedArrayBuffer, which N-API can't create over external memory)
+    static napi_value WaitFrame_NAPI(napi_env env, napi_callback_info info)
+    {
+        if (!env) return NULL; //Node cleanup mode?
+//        DebugInOut("WaitFrame_napi"); //called every frame
+
+        ShmData* shmptr;
+        napi_value argv[2+1], This; //allow 1 extra arg to check for extras
+        size_t argc = SIZEOF(argv);
+        !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+        if ((argc < 1) || (argc > 2)) { NAPI_exc("expected 1-2 args: fr#, [timeout msec], got " << argc << " arg" << plural(argc)); return NULL; }
+        shmptr->isvalid(env, SRCLINE);
+        const int32_t frnum = napi_thingy(env, argv[0]).as_int32(true);
+        const int timeout_msec = (argc > 1)? napi_thingy(env, argv[1]).as_int32(true): 0; //0 = no timeout
+        static const int POLL_MSEC = 50; //re-check port state at least this often
+        FrameControl& frctl = shmptr->m_frctl;
+        const elapsed_t started = Now();
+        ++frctl.numfr_waiters; //register before checking numfr so gpu wker can't miss us
+        for (;;)
+        {
+            const int32_t numfr = *(volatile int32_t*)&frctl.numfr;
+            if ((int32_t)(numfr - frnum) > 0) break; //already consumed
+            if (!frctl.isrunning && !frctl.supervised) break; //port stopped
+            const int remaining = timeout_msec? timeout_msec - (int32_t)(Now() - started): POLL_MSEC;
+            if (remaining <= 0) break; //timed out
+            struct timespec timeout = {0, std::min(remaining, POLL_MSEC) * 1000000L};
+            VOID FrameControl::futex(&frctl.numfr, FUTEX_WAIT, numfr, &timeout); //returns immediately if numfr already changed
+        }
+        --frctl.numfr_waiters;
+        return napi_thingy(env, *(volatile int32_t*)&frctl.numfr, napi_thingy::Int32{});
+    }
 #if 0 //not needed
 public: //named arg variants
     template <typename CALLBACK>
@@ -1500,9 +2692,207 @@ public: //named arg variants
     }
 #endif
 private: //helpers
+//apply real-time options to calling thread; fall back to normal scheduling if not permitted:
+    void rt_setup(SrcLine srcline = 0)
+    {
+        std::ostringstream ss;
+        bool ok = true;
+        if (m_frctl.rtpolicy != SCHED_OTHER)
+        {
+            struct sched_param param = {0};
+            param.sched_priority = std::min(std::max(m_frctl.rtprio, sched_get_priority_min(m_frctl.rtpolicy)), sched_get_priority_max(m_frctl.rtpolicy));
+            int err = pthread_setschedparam(pthread_self(), m_frctl.rtpolicy, &param); //NOTE: returns errno rather than setting it
+            ss << ((m_frctl.rtpolicy == SCHED_RR)? "RR ": "FIFO ") << param.sched_priority << (err? (err == EPERM)? " denied (need CAP_SYS_NICE or rtprio limit)": " failed": " ok");
+            ok &= !err;
+        }
+        if (m_frctl.cpumask)
+        {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            for (int i = 0; i < 32; ++i)
+                if (m_frctl.cpumask & (1u << i)) CPU_SET(i, &cpus);
+            int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+            ss << &", "[ss.tellp()? 0: 2] << "cpus 0x" << std::hex << m_frctl.cpumask << std::dec << (err? " failed": " ok");
+            ok &= !err;
+        }
+        if (m_frctl.mlock)
+        {
+            int err = mlockall(MCL_CURRENT | MCL_FUTURE)? errno: 0;
+            ss << &", "[ss.tellp()? 0: 2] << "mlockall" << (err? ((err == EPERM) || (err == ENOMEM))? " denied (need CAP_IPC_LOCK or ulimit -l)": " failed": " ok");
+            ok &= !err;
+        }
+        strncpy(m_frctl.rt_status, ss.str().c_str(), sizeof(m_frctl.rt_status) - 1);
+        if (!ok) exc_soft("gpu wker rt setup incomplete, using normal scheduling: %s" << ATLINE(srcline), m_frctl.rt_status);
+        else if (m_frctl.rt_status[0]) debug(19, "gpu wker rt setup: %s" << ATLINE(srcline), m_frctl.rt_status);
+    }
+//frame scheduling:
+    inline elapsed_t sched(int32_t frnum) const { return m_frctl.epoch + frnum * m_frctl.frame_time; } //target presentation time
+    inline bool toolate(const FramebufQuent* it) const { return m_frctl.catchup && ((int32_t)(Now() - it->target) > m_frctl.frame_time); } //missed its vsync
+    void recycle(FramebufQuent* it)
+    {
+        it->ready.store(0);
+//                it->prevfr.store(it->frnum.load());
+        it->target = sched(it->frnum + SIZEOF(m_fbque));
+        it->frnum += SIZEOF(m_fbque); //tell wkers which frame to render next;//QUELEN; //NOTE: do this last (wkers look for this)
+        m_frctl.emit(FrameControl::EVT_FREE, it->frnum, it - &m_fbque[0], m_frctl.latest, it->target);
+    }
+//bulk node writes with brightness limit applied:
+//most colors are at or below limit and pass through unchanged
+    static void limit_copy(NODEVAL* __restrict dest, const NODEVAL* __restrict src, size_t count)
+    {
+        static const LimitLUT limiter(BRIGHTEST); //same results as limit<>() without the divides
+        limiter(dest, src, count);
+    }
+    static void limit_fill(NODEVAL* dest, NODEVAL color, size_t count)
+    {
+        color = limit<BRIGHTEST>(color); //only need to do this once
+        std::fill(dest, dest + count, color);
+    }
+//composite all layers for one frame:
+//returns bitmap of univ covered by any layer
+    MASK_TYPE render_effects(FramebufQuent& fbquent, int32_t frnum)
+    {
+        std::shared_ptr<const LayerList> layers = effects(m_frctl.port).snapshot();
+        const MASK_TYPE bits = layer_bits(*layers);
+        for (int x = 0; x < NUM_UNIV; ++x)
+            if (bits & univ_bit(x)) render_univ(fbquent, frnum, x, *layers);
+        return bits;
+    }
+    static MASK_TYPE layer_bits(const LayerList& layers)
+    {
+        MASK_TYPE bits = 0;
+        for (const auto& layer: layers) bits |= univ_bit(layer->fx.univ);
+        return bits;
+    }
+//composite layers for one univ:
+//univ starts black, each layer is rendered into scratch and blended over it, then brightness limit is applied once
+//univ don't share any state, so pool threads can render them in parallel
+    void render_univ(FramebufQuent& fbquent, int32_t frnum, int univ, const LayerList& layers)
+    {
+        static const LimitLUT limiter(BRIGHTEST);
+        const int rowlen = SIZEOF(fbquent.nodes[0]), univlen = m_frctl.wh.h? std::min<int>(m_frctl.wh.h, rowlen): rowlen;
+        NODEVAL scratch[SIZEOF(fbquent.nodes[0])];
+        std::fill(&fbquent.nodes[univ][0], &fbquent.nodes[univ][univlen], BLACK);
+        for (const auto& it: layers)
+        {
+            Layer& layer = *it;
+            const Effect& fx = layer.fx;
+            if (fx.univ != univ) continue;
+            const int len = fx.count? std::min(fx.count, rowlen - fx.ofs): univlen - fx.ofs;
+            if (len <= 0) continue;
+            const auto started = std::chrono::steady_clock::now();
+            NODEVAL* dest = &fbquent.nodes[univ][fx.ofs];
+            if ((fx.blend == Effect::NORMAL) && (fx.opacity >= 1)) fx.render(dest, len, frnum); //opaque; no need for scratch
+            else
+            {
+                fx.render(scratch, len, frnum);
+                fx.composite(dest, scratch, len);
+            }
+            const uint32_t usec = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count();
+            layer.last_usec = usec;
+            layer.total_usec += usec;
+            ++layer.numrender;
+        }
+        limiter(&fbquent.nodes[univ][0], univlen);
+    }
+//queue 1 task per covered univ for each slot recycled since last time; returns #tasks queued:
+    int pool_dispatch(RenderPool& pool)
+    {
+        std::unique_lock<std::mutex> lock(pool.dispatch_mtx, std::try_to_lock);
+        if (!lock.owns_lock()) return 0; //another pool thread is already doing it
+        std::shared_ptr<const LayerList> layers;
+        MASK_TYPE bits = 0;
+        int numtasks = 0;
+        for (int q = 0; q < SIZEOF(m_fbque); ++q)
+        {
+            const int32_t frnum = m_fbque[q].frnum.load();
+            if (frnum == pool.dispatched[q]) continue; //not recycled yet
+            pool.dispatched[q] = frnum;
+            if (!layers) { layers = effects(m_frctl.port).snapshot(); bits = layer_bits(*layers); } //same layers for all slots found this time
+            for (int x = 0; x < NUM_UNIV; ++x)
+            {
+                if (!(bits & univ_bit(x))) continue;
+                RenderPool::TaskQueue& que = pool.queues[x % pool.numthreads]; //initial spread only; stealing evens out the load
+                std::lock_guard<std::mutex> quelock(que.mtx);
+                que.tasks.push_back(RenderTask{q, x, frnum, layers});
+                ++numtasks;
+            }
+        }
+        if (!numtasks) return 0;
+        pool.numqueued += numtasks;
+        pool.idle_cv.notify_all();
+        return numtasks;
+    }
+//pool thread:
+//take a task from own queue (newest first), else steal from another thread's queue (oldest first), else look for recycled slots, else sleep
+    static void pool_wker(ShmData* shmptr, int id)
+    {
+        typedef std::chrono::steady_clock clock;
+        static const int POLL_MSEC = 5; //re-check for recycled slots at least this often
+        RenderPool& pool = pools(shmptr->m_frctl.port);
+        FrameControl& frctl = shmptr->m_frctl;
+        if (pool.cpumask)
+        {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            for (int i = 0; i < 32; ++i)
+                if (pool.cpumask & (1u << i)) CPU_SET(i, &cpus);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus)) debug(12, "pool thread %d: set cpus 0x%x failed", id, pool.cpumask);
+        }
+        auto window = clock::now();
+        int64_t busy_usec = 0;
+        while (pool.running.load())
+        {
+            RenderTask task;
+            bool stolen = false;
+            if (pool.take(id, task, stolen))
+            {
+                const auto started = clock::now();
+                FramebufQuent& fbquent = shmptr->m_fbque[task.qent];
+                if (fbquent.frnum.load() == task.frnum) //skip if slot was recycled again (frame dropped)
+                {
+                    shmptr->render_univ(fbquent, task.frnum, task.univ, *task.layers);
+                    if (fbquent.frnum.load() == task.frnum) fbquent.ready |= univ_bit(task.univ); //don't set bits on later frame; other univ finish on their own
+                }
+                ++frctl.pool_tasks;
+                if (stolen) ++frctl.pool_steals;
+                busy_usec += std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - started).count();
+            }
+            else if (!shmptr->pool_dispatch(pool)) //nothing to do; wait for gpu wker to recycle a slot
+            {
+                if (!id) //thread 0 sleeps on numfr; gpu wker wakes it (any other pool threads are woken when tasks are queued)
+                {
+                    const int32_t numfr = *(volatile int32_t*)&frctl.numfr;
+                    struct timespec timeout = {0, POLL_MSEC * 1000000L};
+                    ++frctl.numfr_waiters;
+                    if (!shmptr->pool_dispatch(pool)) VOID FrameControl::futex(&frctl.numfr, FUTEX_WAIT, numfr, &timeout); //returns immediately if numfr already changed
+                    --frctl.numfr_waiters;
+                }
+                else
+                {
+                    std::unique_lock<std::mutex> lock(pool.idle_mtx);
+                    pool.idle_cv.wait_for(lock, std::chrono::milliseconds(POLL_MSEC), [&pool]{ return pool.numqueued.load() || !pool.running.load(); });
+                }
+            }
+//utilization: %busy over latest 1 sec:
+            const int64_t window_usec = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - window).count();
+            if (window_usec < 1000000) continue;
+            frctl.pool_util[id] = busy_usec * 100 / window_usec;
+            window = clock::now();
+            busy_usec = 0;
+        }
+        frctl.pool_util[id] = 0;
+    }
+//synthesize in-between frame (tweening):
+//per-byte avg of A, R, G, B without overflow (SWAR); simple loop so compiler can vectorize it (NEON/SSE) at -O3
+    static void tween_avg(NODEVAL* __restrict dest, const NODEVAL* __restrict older, const NODEVAL* __restrict newer, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            dest[i] = (older[i] & newer[i]) + (((older[i] ^ newer[i]) & 0xFEFEFEFE) >> 1);
+    }
 //xfr node (color) values to txtr, bit-bang into currently selected protocol format:
 //CAUTION: this needed to run fast because it blocks Node fg thread
-    static void xfr_bb(ShmData& shdata, void* txtrbuf, const void* nodes, size_t xfrlen, SrcLine srcline) // = 0) //, SrcLine srcline2 = 0) //h * pitch(NUM_UNIV)
+    static void xfr_bb(ShmData& shdata, void* txtrbuf, const void* nodes, size_t xfrlen, XFRTYPE* bbprev, SrcLine srcline) // = 0) //, SrcLine srcline2 = 0) //h * pitch(NUM_UNIV)
     {
         FramebufQuent& fbquent = shdata.m_fbque[shdata.m_frctl.numfr % SIZEOF(shdata.m_fbque)]; //CAUTION: circular queue
         XFRTYPE bbdata/*[UNIV_MAX]*/[BIT_SLICES]; //3 * NODEBITS]; //bit-bang buf; enough for *1 row* only; dcl in heap so it doesn't need to be fully re-initialized every time
@@ -1514,7 +2904,9 @@ private: //helpers
 //        SDL_Size nodes_wh(NUM_UNIV, gp.m_wh.h);
 
         if (/*!shdata.m_frctl.wh.w || !shdata.m_frctl.wh.h ||*/ !xfrlen || (shdata.m_frctl.wh.w != NUM_UNIV /*SIZEOF(bbdata)*/) || (xfrlen != shdata.m_frctl.wh.h * sizeof(bbdata) /*gp.m_wh./-*datalen<XFRTYPE>()*-/ w * sizeof(XFRTYPE)*/)) exc_hard("xfr size mismatch: nodebuf " << shdata.m_frctl.wh << " vs. " << SDL_Size(NUM_UNIV, SIZEOF(fbquent.nodes[0]) /*UNIV_MAXLEN_pad*/) << ", byte count " << commas(xfrlen) << " vs, " << commas(shdata.m_frctl.wh.h * sizeof(bbdata)));
-        if (nodes != &fbquent.nodes[0][0]) exc_hard("&nodes[0][0] " << nodes << " != &fbquent.nodes[0][0] " << &fbquent.nodes[0][0]);
+//        if (nodes != &fbquent.nodes[0][0]) exc_hard("&nodes[0][0] " << nodes << " != &fbquent.nodes[0][0] " << &fbquent.nodes[0][0]);
+        const bool synth = (nodes != &fbquent.nodes[0][0]); //tweened frame (not in fbque)
+        const decltype(fbquent.nodes)& frnodes = *static_cast<const decltype(fbquent.nodes)*>(nodes); //2D addressing
 //        SDL_Size wh_bb(NUM_UNIV, H_PADDED), wh_txtr(XFRW/*_PADDED*/, xfrlen / XFRW/*_PADDED*/ / sizeof(XFRTYPE)); //NOTE: txtr w is XFRW_PADDED, not XFRW
 //        if (!(count++ % 100))
 //        static int count = 0;
@@ -1529,8 +2921,9 @@ private: //helpers
 //adds no extra run-time overhead if protocol is checked outside the loops
 //3x as many x accesses as y accesses are needed, so pixels (horizontally adjacent) are favored over nodes (vertically adjacent) to get better memory cache performance
         static const bool rbswap = false; //isRPi(); //R <-> G swap only matters for as-is display; for pivoted data, user can just swap I/O pins
-        /*auto*/ MASK_TYPE dirty = fbquent.ready.load() | (255 * Ashift); //use dirty/ready bits as start bits
+        /*auto*/ MASK_TYPE dirty = synth? ALL_UNIV: fbquent.ready.load() | (255 * Ashift); //use dirty/ready bits as start bits; synthesized frames are complete
         if (shdata.m_frctl.protocol != shdata.m_frctl.prev_protocol) dirty = ALL_UNIV; //protocol/fmt changed; force all nodes to be updated (for dev/debug); wouldn't happen in prod
+        const MASK_TYPE late = bbprev? ~dirty & ALL_UNIV: 0; //partial frame: these univ reuse previous bits
         debug(19, "xfr " << commas(xfrlen) << " *3, protocol " << shdata.m_frctl.protocol); //static_cast<int>(nodebuf.protocol) << ENDCOLOR);
 //        if (debug_level <= 80)
 #define DUMP_LEVEL  80
@@ -1539,7 +2932,7 @@ private: //helpers
         int yy = shdata.m_frctl.wh.h;
         while ((yy > 1) /*&& (fbquent.nodes[*][yy - 1] == fbquent.nodes[*][yy - 2])*/) //--yy;
             for (int x = 0; x < NUM_UNIV; ++x)
-                if (fbquent.nodes[x][yy - 1] != fbquent.nodes[x][yy - 2]) { yy = -yy; break; }
+                if (frnodes[x][yy - 1] != frnodes[x][yy - 2]) { yy = -yy; break; }
                 else if (x == NUM_UNIV - 1) --yy; //truncate repeating rows
         if (yy < 0) yy = -yy; //kludge: restore unique len after outer loop break
         for (int y = 0; y < /*shdata.m_frctl.wh.h*/ yy; ++y) //outer loop = node# within each universe
@@ -1547,10 +2940,10 @@ private: //helpers
             std::ostringstream ss;
             ss << "[" << y << "/" << shdata.m_frctl.wh.h << "]:'" << std::hex << &"0x"[(y * NUM_UNIV < 10)? 2: 0] << (y * NUM_UNIV);
             int xx = NUM_UNIV;
-            while ((xx > 1) && (fbquent.nodes[xx - 1][y] == fbquent.nodes[xx - 2][y])) --xx; //truncate repeating cells
+            while ((xx > 1) && (frnodes[xx - 1][y] == frnodes[xx - 2][y])) --xx; //truncate repeating cells
             for (int x = 0; x < /*NUM_UNIV*/ xx; ++x) //inner loop = universe#
             {
-                ss << (x? ", ": ": ") << &"0x"[(fbquent.nodes[x][y] < 10)? 2: 0] << fbquent.nodes[x][y];
+                ss << (x? ", ": ": ") << &"0x"[(frnodes[x][y] < 10)? 2: 0] << frnodes[x][y];
 //                for (int xx = x + 1; xx < NUM_UNIV; ++xx) //look ahead for changes
 //                    if (fbquent.nodes[xx][y] != fbquent.nodes[x][y])) break;
 //                    else if (xx == NUM_UNIV - 1) ss << " ...";
@@ -1567,7 +2960,7 @@ private: //helpers
                 for (int y = 0; y < shdata.m_frctl.wh.h; ++y) //outer loop = node# within each universe
                     for (uint32_t x = 0, /*xofs = 0,*/ xmask = NODEVAL_MSB; x < NUM_UNIV; ++x, /*xofs += nodebuf.wh.h,*/ xmask >>= 1) //inner loop = universe#
                     {
-                        NODEVAL color_out = limit<BRIGHTEST>(fbquent.nodes[x][/*xofs +*/ y]); //limit() is marginally useful in this mode, but use it in case view wants accuracy
+                        NODEVAL color_out = limit<BRIGHTEST>(frnodes[x][/*xofs +*/ y]); //limit() is marginally useful in this mode, but use it in case view wants accuracy
                         if (!A(color_out) || !(dirty & xmask)) continue; //no change to node; since is portraying nodes so leave old value on screen
                         *ptr++ = *ptr++ = *ptr++ = /*(dirty & xmask)?*/ rbswap? ARGB2ABGR(color_out): color_out; //: BLACK; //copy as-is (3x width)
                     }
@@ -1579,7 +2972,7 @@ private: //helpers
                     for (uint32_t x = 0, /*xofs = 0,*/ xmask = NODEVAL_MSB; x < NUM_UNIV; ++x, /*xofs += nodebuf.wh.h,*/ xmask >>= 1) //inner loop = universe#
                     {
                         static const Uint32 ByteColors[] {RED, GREEN, BLUE}; //only for dev/debug
-                        NODEVAL color_out = limit<BRIGHTEST>(fbquent.nodes[x][/*xofs +*/ y]); //limit() is marginally useful in this mode, but use it in case view wants accuracy
+                        NODEVAL color_out = limit<BRIGHTEST>(frnodes[x][/*xofs +*/ y]); //limit() is marginally useful in this mode, but use it in case view wants accuracy
 //show start + stop bits around unpivoted data:
 //NOTE: start/stop bits portray formatted protocol, middle node section *does not*
                         *ptr++ = ByteColors[x / 8] & xmask; //show byte (color) indicator (easier dev/debug); //dirty; //WHITE;
@@ -1607,7 +3000,8 @@ private: //helpers
 //NOTE: xmask loop assumes ARGB or ABGR fmt (A in upper byte)
                     for (uint32_t x = 0, xofs = 0, xmask = NODEVAL_MSB /*1 << (NUM_UNIV - 1)*/; x < NUM_UNIV; ++x, xofs += shdata.m_frctl.wh.h, xmask >>= 1) //inner loop = universe#
                     {
-                        XFRTYPE color_out = limit<BRIGHTEST>(fbquent.nodes[x][y]); //[0][xofs + y]; //pixels? pixels[xofs + y]: fill;
+                        if (late & xmask) continue; //late univ; previous bits restored below
+                        XFRTYPE color_out = limit<BRIGHTEST>(frnodes[x][y]); //[0][xofs + y]; //pixels? pixels[xofs + y]: fill;
 //                            if (!A(color) || (!R(color) && !G(color) && !B(color))) continue; //no data to pivot
 //                        if (rbswap) color_out = ARGB2ABGR(color_out); //user-requested explicit R <-> G swap
 //no                            color = ARGB2ABGR(color); //R <-> G swap doesn't need to be automatic for RPi; user can swap GPIO pins
@@ -1654,6 +3048,12 @@ private: //helpers
                     if (color_out & 0x000001) ptr[yofs + 3*23 + 1] |= xmask;
 #endif
                     }
+//late univ own distinct bit positions, so their previous columns can be merged back in without re-encoding:
+                    if (!bbprev) continue;
+                    if (late)
+                        for (int bit = 0; bit < BIT_SLICES; ++bit)
+                            ptr[yofs + bit] = (ptr[yofs + bit] & ~late) | (bbprev[yofs + bit] & late);
+                    memcpy(&bbprev[yofs], &ptr[yofs], sizeof(bbdata)); //save for next partial frame
                 }
                 break;
         }
@@ -3005,7 +4405,7 @@ protected: //private data members
 
 //limit brightness:
 //NOTE: JS <-> C++ overhead is significant for this function
-//it's probably better to just use a pure JS function for high-volume usage
+//for high-volume usage, use limitArray() or setUniverse() instead
 napi_value Limit_NAPI(napi_env env, napi_callback_info info)
 {
     if (!env) return NULL; //Node cleanup mode?
@@ -3040,6 +4440,102 @@ napi_value Limit_NAPI(napi_env env, napi_callback_info info)
 }
 
 
+//limit brightness of all colors in a typed array (in place):
+//one call per array instead of per color; uses reciprocal LUT instead of divides
+//optional 2nd arg is max brightness (%); default is same as limit()
+napi_value LimitArray_NAPI(napi_env env, napi_callback_info info)
+{
+    if (!env) return NULL; //Node cleanup mode?
+//    DebugInOut("LimitArray_napi");
+
+    ShmData* shmptr; //not used
+    napi_value argv[2+1], This; //allow 1 extra arg to check for extras
+    size_t argc = SIZEOF(argv);
+    !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+    if ((argc < 1) || (argc > 2)) { NAPI_exc("expected 1-2 params (Uint32Array, max bright), got " << argc << " params"); return NULL; }
+    void* data;
+    napi_value arybuf;
+    size_t arylen, bofs;
+    napi_typedarray_type arytype;
+    if (!napi_thingy(env, argv[0]).istypary()) { NAPI_exc("expected Uint32Array, got " << napi_thingy(env, argv[0])); return NULL; }
+    !NAPI_OK(napi_get_typedarray_info(env, argv[0], &arytype, &arylen, &data, &arybuf, &bofs), "Get typed array info failed");
+    if ((arytype != napi_uint32_array) && (arytype != napi_int32_array)) { NAPI_exc("expected Uint32Array, got typed array type " << arytype); return NULL; }
+    static const LimitLUT deflimit(ShmData::BRIGHTEST); //build once for default limit
+    const int maxbright = (argc > 1)? napi_thingy(env, argv[1]).as_int32(true): ShmData::BRIGHTEST;
+    if ((maxbright < 0) || (maxbright > 100)) { NAPI_exc("invalid max brightness: " << maxbright << "% (expected 0..100)"); return NULL; }
+    if (maxbright == ShmData::BRIGHTEST) deflimit(static_cast<Uint32*>(data), arylen);
+    else LimitLUT(maxbright)(static_cast<Uint32*>(data), arylen); //766 divides to build LUT; still cheaper than per color for large arrays
+    return argv[0]; //allow chaining
+}
+
+
+//batch color conversions; one call per univ/array instead of JS hsv2rgb()/toargb() per node:
+//hsv2argb(Float32Array hsv, dest[, maxBright]) and rgbf2argb(Float32Array rgb, dest[, maxBright]) take interleaved triplets 0..1
+//palette2argb(Uint8Array/Uint16Array/Uint32Array indexes, Uint32Array palette, dest[, maxBright]) looks up each index
+//dest is any Uint32Array, including nodebufs[qent].nodes[univ] (writes straight into shm); brightness limit is applied (default same as limit(), 100 = none)
+//returns dest
+enum { CVT_HSV = 0, CVT_RGBF, CVT_PALETTE };
+napi_value Convert_NAPI(napi_env env, napi_callback_info info, int kind)
+{
+    if (!env) return NULL; //Node cleanup mode?
+//    DebugInOut("Convert_napi"); //called for every univ every frame
+
+    ShmData* shmptr; //not used
+    napi_value argv[4+1], This; //allow 1 extra arg to check for extras
+    size_t argc = SIZEOF(argv);
+    !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, (void**)&shmptr), "Get cb info failed");
+    const size_t numargs = (kind == CVT_PALETTE)? 3: 2; //required args
+    if ((argc < numargs) || (argc > numargs + 1)) NAPI_exc("expected " << numargs << "-" << (numargs + 1) << " params (" << ((kind == CVT_PALETTE)? "indexes, palette": "Float32Array") << ", Uint32Array, max bright), got " << argc << " params");
+    void* data[3];
+    size_t arylen[3], bofs;
+    napi_typedarray_type arytype[3];
+    napi_value arybuf;
+    for (size_t i = 0; i < numargs; ++i)
+    {
+        if (!napi_thingy(env, argv[i]).istypary()) { NAPI_exc("expected typed array for param " << (i + 1) << ", got " << napi_thingy(env, argv[i])); return NULL; }
+        !NAPI_OK(napi_get_typedarray_info(env, argv[i], &arytype[i], &arylen[i], &data[i], &arybuf, &bofs), "Get typed array info failed");
+    }
+    const size_t dst = numargs - 1; //dest is last typed array
+    if ((arytype[dst] != napi_uint32_array) && (arytype[dst] != napi_int32_array)) NAPI_exc("expected Uint32Array dest, got typed array type " << arytype[dst]);
+    if ((kind == CVT_PALETTE) && (arytype[1] != napi_uint32_array) && (arytype[1] != napi_int32_array)) NAPI_exc("expected Uint32Array palette, got typed array type " << arytype[1]);
+    if ((kind != CVT_PALETTE) && (arytype[0] != napi_float32_array)) NAPI_exc("expected Float32Array, got typed array type " << arytype[0]);
+    const size_t count = (kind == CVT_PALETTE)? arylen[0]: arylen[0] / 3;
+    if (count > arylen[dst]) NAPI_exc(count << " colors overruns dest len " << arylen[dst]);
+    const int maxbright = (argc > numargs)? napi_thingy(env, argv[numargs]).as_int32(true): ShmData::BRIGHTEST;
+    if ((maxbright < 0) || (maxbright > 100)) NAPI_exc("invalid max brightness: " << maxbright << "% (expected 0..100)");
+    bool failed;
+    !NAPI_OK(napi_is_exception_pending(env, &failed), "Check exc pending failed");
+    if (failed) return NULL;
+    static const LimitLUT deflimit(ShmData::BRIGHTEST); //build once for default limit
+    std::unique_ptr<LimitLUT> custom((maxbright != ShmData::BRIGHTEST)? new LimitLUT(maxbright): nullptr);
+    const LimitLUT& limiter = custom? *custom: deflimit;
+    Uint32* dest = static_cast<Uint32*>(data[dst]);
+    switch (kind)
+    {
+        case CVT_HSV: hsv2argb(dest, static_cast<const float*>(data[0]), count); break;
+        case CVT_RGBF: rgbf2argb(dest, static_cast<const float*>(data[0]), count); break;
+        case CVT_PALETTE:
+        {
+            std::unique_ptr<Uint32[]> palette(new Uint32[arylen[1]]);
+            limiter(palette.get(), static_cast<const Uint32*>(data[1]), arylen[1]); //limit palette once instead of every color
+            switch (arytype[0])
+            {
+                case napi_uint8_array: case napi_uint8_clamped_array: palette2argb(dest, static_cast<const uint8_t*>(data[0]), count, palette.get(), arylen[1]); break;
+                case napi_uint16_array: palette2argb(dest, static_cast<const uint16_t*>(data[0]), count, palette.get(), arylen[1]); break;
+                case napi_uint32_array: palette2argb(dest, static_cast<const uint32_t*>(data[0]), count, palette.get(), arylen[1]); break;
+                default: NAPI_exc("expected Uint8Array, Uint16Array or Uint32Array indexes, got typed array type " << arytype[0]); return NULL;
+            }
+            return argv[dst]; //already limited
+        }
+    }
+    limiter(dest, count);
+    return argv[dst]; //allow chaining
+}
+napi_value Hsv2Argb_NAPI(napi_env env, napi_callback_info info) { return Convert_NAPI(env, info, CVT_HSV); }
+napi_value Rgbf2Argb_NAPI(napi_env env, napi_callback_info info) { return Convert_NAPI(env, info, CVT_RGBF); }
+napi_value Palette2Argb_NAPI(napi_env env, napi_callback_info info) { return Convert_NAPI(env, info, CVT_PALETTE); }
+
+
 //C++ debug() shim:
 napi_value Debug_NAPI(napi_env env, napi_callback_info info)
 {
@@ -3422,6 +4918,153 @@ napi_value Listen_NAPI(napi_env env, napi_callback_info info)
 //};
 
 
+//serialize attach/detach within a proc:
+//main thread + worker_threads each attach separately, and only the first one may run the ctor (last one runs the dtor)
+static std::mutex& attach_mtx() { static std::mutex m_mtx; return m_mtx; } //kludge: avoid static member decl at global scope
+//attach to (or create) shm seg for one GPU port and wrap it in a JS object:
+//each port has its own shm key, gpu wker and vsync so several screens/outputs can run at once
+napi_value GpuPortInit(napi_env env, int port, napi_value exports)
+{
+    std::unique_lock<std::mutex> lock(attach_mtx()); //until ctor done
+    std::unique_ptr<ShmData> shmdata(ShmData::my(shmalloc_debug(sizeof(ShmData), ShmData::port_shmkey(port), SRCLINE))); // ) ShmData(env, SRCLINE)); //(GpuPortData*)malloc(sizeof(*addon_data));
+    if (!shmdata) NAPI_exc("alloc shmdata failed: " << strerror(errno));
+    ShmData* shmptr = shmdata.get();
+    bool isnew = (shmnattch(shmptr) == 1);
+//printf("ModuleInit: shmptr %p, isnew? %d, valid? %d @%s\n", shmptr, isnew, shmptr->isvalid(), SRCLINE); fflush(stdout);
+    debug(5, "PortInit[%d]: shmptr %p, #attach %d, valid? %d, isnew? %d, shm opts 0x%x (wanted 0x%x)", port, shmptr, shmnattch(shmptr), shmptr->isvalid(), isnew, get_shmhdr(shmptr)->opts, shm_opts);
+    if (isnew) new (shmptr) ShmData(port); //placement "new" to call ctor; CAUTION: first time only
+    else if (shmptr->m_ver != ShmData::VERSION) //left over from older build; layout might differ even if size matches
+    {
+        const int32_t stale_ver = shmptr->m_ver; //bytes[4..7] in all versions
+        shmfree_debug(shmdata.release(), SRCLINE); //dettach; don't reinterpret
+        NAPI_exc("stale shmdata for port " << port << ": ver 0x" << std::hex << stale_ver << ", expected 0x" << ShmData::VERSION << std::dec << "; stop other procs using it and remove it (ipcrm or /dev/shm)");
+        return NULL;
+    }
+    lock.unlock();
+    if (/*(shmdata.get() != shmptr) ||*/ !shmptr->isvalid()) NAPI_exc((isnew? "alloc": "reattch") << " shmdata " << shmptr << " failed");
+    napi_thingy my_exports(env, shmptr->my_exports(env, exports));
+    vector_cxx17<my_napi_property_descriptor> props;
+    add_prop_uint32("shm_opts", get_shmhdr(shmptr)->opts)(props.emplace_back()); //backend + options actually applied (mlock/huge pages might not be available)
+    my_exports += props;
+    if (/*(shmdata.get() != shmptr) ||*/ !shmptr->isvalid()) NAPI_exc((isnew? "alloc": "reattch") << " shmdata " << shmptr << " failed"); //paranoid/debug; check again
+//wrap internal data with module exports object:
+  // Associate the addon data with the exports object, to make sure that when the addon gets unloaded our data gets freed.
+//    void* NO_HINT = NULL; //optional finalize_hint
+// Free the per-addon-instance data.
+//TODO: find out why this is not being called
+    napi_finalize /*std::function<void(napi_env, void*, void*)>*/ addon_final = [](napi_env env, void* shmdata, void* hint)
+    {
+        UNUSED(hint);
+//        GpuPortData* aoptr = static_cast<GpuPortData*>(aodata); //(GpuPortData*)data;
+        ShmData* shmptr = ShmData::my(shmdata); //(GpuPortData*)data;
+//    if (!env) return; //Node cleanup mode
+        debug(9, RED_MSG "addon finalize: aodata %p, valid? %d, open? %d, hint %p, #nattch %d", shmptr, shmptr->isvalid(), shmptr->isopen(), hint, shmnattch(shmptr));
+//        aoptr->isvalid(env);
+//        if (aoptr->isopen()) NAPI_exc("GpuPort still open");
+//        aoptr->reset(env);
+//        !NAPI_OK(napi_delete_reference(env, shmptr->ref), "Del ref failed");
+//        shmptr->ref = nullptr;
+        ShmData::drop_pools(shmptr); //pool threads use this attachment
+        std::lock_guard<std::mutex> lock(attach_mtx());
+        if (shmnattch(shmptr) == 1) shmptr->~ShmData(); //call dtor before dealloc/dettach
+//        delete shmptr; //free(addon_data);
+        shmfree_debug(shmptr, SRCLINE); //dealloc/dettach
+    };
+//debug(9, BLUE_MSG "here15" ENDCOLOR);
+    napi_ref* NO_REF = NULL; //optional ref to wrapped object
+    !NAPI_OK(napi_wrap(env, my_exports, shmptr, addon_final, /*aoptr.get()*/NO_HINT, /*&shmptr->ref*/ NO_REF), "Wrap shmdata failed");
+  // Return the decorated exports object.
+//    napi_status status;
+//    INSPECT(CYAN_MSG "napi init: " << *aoptr, SRCLINE);
+//debug(9, BLUE_MSG "here16" ENDCOLOR);
+//    aoptr->isvalid(env);
+//debug(9, BLUE_MSG "here17" ENDCOLOR);
+    if (/*(shmdata.get() != shmptr) ||*/ !shmptr->isvalid()) NAPI_exc((isnew? "alloc": "reattch") << " shmdata " << shmptr << " failed"); //paranoid/debug; check again
+    shmdata.release(); //NAPI owns it now; finalize will clean it up
+    return my_exports;
+}
+//per-env addon data:
+//addon is context-aware; main thread and each worker_thread load it into their own env and attach to the same ShmData (thru shm)
+//JS objects can't be shared across envs, so port objects are cached per env
+struct AddonData
+{
+    napi_ref port_refs[ShmData::MAX_PORTS] = {0}; //weak refs; finalize detaches when JS drops a port object
+//get (or create) data for this env:
+    static AddonData* my(napi_env env)
+    {
+        AddonData* aodata = NULL;
+        !NAPI_OK(napi_get_instance_data(env, (void**)&aodata), "Get instance data failed");
+        if (aodata) return aodata;
+        aodata = new AddonData;
+        !NAPI_OK(napi_set_instance_data(env, aodata, AddonData::final, NULL), "Set instance data failed");
+        return aodata;
+    }
+//env is going away (Node exit or worker_thread exit):
+    static void final(napi_env env, void* data, void* hint)
+    {
+        UNUSED(hint);
+        AddonData* aodata = static_cast<AddonData*>(data);
+        debug(9, RED_MSG "instance data finalize: env %p, aodata %p", env, aodata);
+        for (auto& ref: aodata->port_refs)
+            if (ref) VOID napi_delete_reference(env, ref);
+        ShmData::FrameControl::drop_listeners(env);
+        ShmData::FrameControl::drop_waiters(env);
+        ShmData::drop_pools(env);
+        delete aodata;
+    }
+};
+//daemon proc entry point; exec()ed by open({daemon: true}):
+//attaches to GPU port shm by key and runs gpu wker until port is closed
+napi_value DaemonMain_NAPI(napi_env env, napi_callback_info info)
+{
+    if (!env) return NULL; //Node cleanup mode?
+    napi_value argv[4+1], This; //allow 1 extra arg to check for extras
+    size_t argc = SIZEOF(argv);
+    !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, NULL), "Get cb info failed");
+    if (argc != 4) { NAPI_exc("expected 4 args: port#, screen, vgroup, color, got " << argc << " arg" << plural(argc)); return NULL; }
+    const int port = napi_thingy(env, argv[0]).as_int32(true);
+    const int screen = napi_thingy(env, argv[1]).as_int32(true);
+    const int vgroup = napi_thingy(env, argv[2]).as_int32(true);
+    const NODEVAL init_color = napi_thingy(env, argv[3]).as_uint32(true);
+    if ((port < 0) || (port >= ShmData::MAX_PORTS)) { NAPI_exc("invalid port# " << port << ", max " << (ShmData::MAX_PORTS - 1)); return NULL; }
+    ShmData* shmptr = ShmData::my(shmalloc_debug(sizeof(ShmData), ShmData::port_shmkey(port), SRCLINE)); //own attach; not wrapped, so freed below
+    if (!shmptr) { NAPI_exc("attach shmdata failed: " << strerror(errno)); return NULL; }
+    if ((shmnattch(shmptr) == 1) || (shmptr->m_ver != ShmData::VERSION) || !shmptr->isvalid()) //opener gone or different build; don't touch it
+    {
+        VOID shmfree_debug(shmptr, SRCLINE);
+        NAPI_exc("daemon: no valid shmdata for port " << port);
+        return NULL;
+    }
+    shmptr->daemon_main(screen, vgroup, init_color, SRCLINE);
+    std::lock_guard<std::mutex> lock(attach_mtx());
+    if (shmnattch(shmptr) == 1) shmptr->~ShmData(); //no Node procs attached
+    VOID shmfree_debug(shmptr, SRCLINE);
+    return NULL;
+}
+//get JS object for another GPU port; port 0 is the module exports object:
+napi_value Port_NAPI(napi_env env, napi_callback_info info)
+{
+    if (!env) return NULL; //Node cleanup mode?
+    DebugInOut("Port_napi");
+
+    napi_value argv[1+1], This; //allow 1 extra arg to check for extras
+    size_t argc = SIZEOF(argv);
+    !NAPI_OK(napi_get_cb_info(env, info, &argc, argv, &This, NULL), "Get cb info failed");
+    if (argc != 1) { NAPI_exc("expected 1 arg: port#, got " << argc << " arg" << plural(argc)); return NULL; }
+    napi_thingy argval(env, argv[0]);
+    int port = argval.as_int32(true);
+    if ((port < 0) || (port >= ShmData::MAX_PORTS)) { NAPI_exc("invalid port# " << port << ", max " << (ShmData::MAX_PORTS - 1)); return NULL; }
+    napi_ref& ref = AddonData::my(env)->port_refs[port];
+    napi_value retval = NULL;
+    if (ref) !NAPI_OK(napi_get_reference_value(env, ref, &retval), "Get port ref failed");
+    if (retval) return retval; //already attached
+    if (ref) !NAPI_OK(napi_delete_reference(env, ref), "Del port ref failed"); //JS dropped it; attach again
+    retval = GpuPortInit(env, port, napi_thingy(env, napi_thingy::Object{}));
+    !NAPI_OK(napi_create_reference(env, retval, 0, &ref), "Cre port ref failed");
+    return retval;
+}
+
+
 //export napi functions to js callers:
 napi_value GpuModuleInit(napi_env env, napi_value exports)
 {
@@ -3456,15 +5099,14 @@ napi_value GpuModuleInit(napi_env env, napi_value exports)
 //    ShmData* shmptr = shmalloc_typesafe<ShmData>(ShmData::SHMKEY, 1, SRCLINE);
 //    ShmDeleter dtor = std::bind(shmfree_typesafe<ShmData>, std::placeholders::_1, SRCLINE);
 //    std::unique_ptr<ShmData, ShmDeleter> shmdata(shmptr, dtor); // ) ShmData(env, SRCLINE)); //(GpuPortData*)malloc(sizeof(*addon_data));
-    std::unique_ptr<ShmData> shmdata(ShmData::my(shmalloc_debug(sizeof(ShmData), ShmData::FramebufQuent::SHMKEY, SRCLINE))); // ) ShmData(env, SRCLINE)); //(GpuPortData*)malloc(sizeof(*addon_data));
-    ShmData* shmptr = shmdata.get();
-    bool isnew = (shmnattch(shmptr) == 1);
-//printf("ModuleInit: shmptr %p, isnew? %d, valid? %d @%s\n", shmptr, isnew, shmptr->isvalid(), SRCLINE); fflush(stdout);
-    debug(5, "ModuleInit: shmptr %p, #attach %d, valid? %d, isnew? %d", shmptr, shmnattch(shmptr), shmptr->isvalid(), isnew);
-    if (isnew) new (shmptr) ShmData; //placement "new" to call ctor; CAUTION: first time only
-    if (/*(shmdata.get() != shmptr) ||*/ !shmptr->isvalid()) NAPI_exc((isnew? "alloc": "reattch") << " shmdata " << shmptr << " failed");
-    napi_thingy my_exports(env, shmptr->my_exports(env, exports));
-    if (/*(shmdata.get() != shmptr) ||*/ !shmptr->isvalid()) NAPI_exc((isnew? "alloc": "reattch") << " shmdata " << shmptr << " failed"); //paranoid/debug; check again
+//select shm backend before first alloc; all procs sharing ShmData must use the same one (cluster wkers inherit env):
+//GPUPORT_SHM=posix[,huge][,mlock][,prefault]; default is SysV
+    const char* shmenv = NVL(getenv("GPUPORT_SHM"), "");
+    if (strstr(shmenv, "posix")) shm_opts = SHM_POSIX | (strstr(shmenv, "huge")? SHM_HUGEPAGE: 0) | (strstr(shmenv, "mlock")? SHM_MLOCK: 0) | (strstr(shmenv, "prefault")? SHM_PREFAULT: 0);
+    napi_thingy my_exports(env, GpuPortInit(env, 0, exports)); //port 0 is the module exports object
+    ShmData* shmptr;
+    !NAPI_OK(napi_unwrap(env, my_exports, (void**)&shmptr), "Unwrap shmdata failed");
+    !NAPI_OK(napi_create_reference(env, my_exports, 0, &AddonData::my(env)->port_refs[0]), "Cre port ref failed");
 //    debug(11, BLUE_MSG "aodata %p, &node[0][0[0] %p" ENDCOLOR, aoptr, &aoptr->m_nodebq[0].nodes[0][0]);
 //    inout.checkpt("cre data");
 //    aoptr->isvalid(env);
@@ -3476,9 +5118,17 @@ napi_value GpuModuleInit(napi_env env, napi_value exports)
 //kludge: use lambas in lieu of C++ named member init:
 //(named args easier to maintain than long param lists)
     add_method("limit", Limit_NAPI, shmptr)(props.emplace_back()); //(*pptr++);
+    add_method("limitArray", LimitArray_NAPI, shmptr)(props.emplace_back());
+    add_method("hsv2argb", Hsv2Argb_NAPI, shmptr)(props.emplace_back());
+    add_method("rgbf2argb", Rgbf2Argb_NAPI, shmptr)(props.emplace_back());
+    add_method("palette2argb", Palette2Argb_NAPI, shmptr)(props.emplace_back());
     add_method("debug", Debug_NAPI, shmptr)(props.emplace_back()); //(*pptr++);
     add_method("read_debug", ReadDebug_NAPI, shmptr)(props.emplace_back()); //(*pptr++);
     add_method("detail", Detail_NAPI, shmptr)(props.emplace_back()); //(*pptr++);
+    add_method("port", Port_NAPI, shmptr)(props.emplace_back());
+    add_method("daemonMain", DaemonMain_NAPI, shmptr)(props.emplace_back());
+    add_prop_uint32("MAX_PORTS", ShmData::MAX_PORTS)(props.emplace_back());
+    add_prop_uint32("MAX_BRIGHT", ShmData::BRIGHTEST)(props.emplace_back()); //default max brightness (%) for limit() and limitArray()
 //    add_method("open", ShmData::Open_NAPI, shmptr)(methods.emplace_back()); //(*pptr++);
 //    add_method("close", ShmData::Close_NAPI, shmptr)(methods.emplace_back()); //(*pptr++);
 #if 0 //broken in slave process
@@ -3573,38 +5223,6 @@ napi_value GpuModuleInit(napi_env env, napi_value exports)
 //    methods = shmptr->my_exports(env, methods);
 //debug(9, BLUE_MSG "here14" ENDCOLOR);
 
-//wrap internal data with module exports object:
-  // Associate the addon data with the exports object, to make sure that when the addon gets unloaded our data gets freed.
-//    void* NO_HINT = NULL; //optional finalize_hint
-// Free the per-addon-instance data.
-//TODO: find out why this is not being called
-    napi_finalize /*std::function<void(napi_env, void*, void*)>*/ addon_final = [](napi_env env, void* shmdata, void* hint)
-    {
-        UNUSED(hint);
-//        GpuPortData* aoptr = static_cast<GpuPortData*>(aodata); //(GpuPortData*)data;
-        ShmData* shmptr = ShmData::my(shmdata); //(GpuPortData*)data;
-//    if (!env) return; //Node cleanup mode
-        debug(9, RED_MSG "addon finalize: aodata %p, valid? %d, open? %d, hint %p, #nattch %d", shmptr, shmptr->isvalid(), shmptr->isopen(), hint, shmnattch(shmptr));
-//        aoptr->isvalid(env);
-//        if (aoptr->isopen()) NAPI_exc("GpuPort still open");
-//        aoptr->reset(env);
-//        !NAPI_OK(napi_delete_reference(env, shmptr->ref), "Del ref failed");
-//        shmptr->ref = nullptr;
-        if (shmnattch(shmptr) == 1) shmptr->~ShmData(); //call dtor before dealloc/dettach
-//        delete shmptr; //free(addon_data);
-        shmfree_debug(shmptr, SRCLINE); //dealloc/dettach
-    };
-//debug(9, BLUE_MSG "here15" ENDCOLOR);
-    napi_ref* NO_REF = NULL; //optional ref to wrapped object
-    !NAPI_OK(napi_wrap(env, my_exports, shmptr, addon_final, /*aoptr.get()*/NO_HINT, /*&shmptr->ref*/ NO_REF), "Wrap shmdata failed");
-  // Return the decorated exports object.
-//    napi_status status;
-//    INSPECT(CYAN_MSG "napi init: " << *aoptr, SRCLINE);
-//debug(9, BLUE_MSG "here16" ENDCOLOR);
-//    aoptr->isvalid(env);
-//debug(9, BLUE_MSG "here17" ENDCOLOR);
-    if (/*(shmdata.get() != shmptr) ||*/ !shmptr->isvalid()) NAPI_exc((isnew? "alloc": "reattch") << " shmdata " << shmptr << " failed"); //paranoid/debug; check again
-    shmdata.release(); //NAPI owns it now; finalize will clean it up
 //debug(9, BLUE_MSG "here18" ENDCOLOR);
     return my_exports;
 }
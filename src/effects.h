@@ -0,0 +1,213 @@
+//native effect primitives:
+//each effect renders a node range of one univ as a pure function of fr#, so any proc/thread can render any frame (or skip dropped ones)
+//JS sets params once per cue; per-frame work is plain loops over nodes in C++
+//effects are also layers: each one is composited over the ones before it with its own blend mode and opacity
+
+#if !defined(_EFFECTS_H) && !defined(WANT_UNIT_TEST) //force unit test to explicitly #include this file
+#define _EFFECTS_H //CAUTION: put this before defs to prevent loop on cyclic #includes
+
+#include <stdint.h> //uint*_t
+#include <string.h> //strcmp()
+#include <cmath> //floor()
+#include <cstdlib> //abs()
+#include <algorithm> //std::min(), std::max()
+#include <ostream> //std::ostream
+#include "str-helpers.h" //STATIC
+#include "rgb-helpers.h" //hsv2argb(), R(), G(), B(), fromRGB()
+
+
+struct Effect
+{
+    enum Kind: int { NONE = 0, FILL, GRADIENT, CHASE, TWINKLE, FADE, WIPE, RAINBOW, SPARKLE, NUM_KINDS };
+    enum Blend: int { NORMAL = 0, ADD, MAX, MULTIPLY, ALPHA, NUM_BLENDS };
+    int kind = NONE;
+    int univ = 0, ofs = 0, count = 0; //node range; count 0 = rest of univ
+    uint32_t color = WHITE, color2 = BLACK; //foreground, background
+    int32_t start = 0; //fr# when cue started; time-based effects count from here
+    int period = 0; //frames per cycle (twinkle, fade, wipe, rainbow) or nodes between lit nodes (chase)
+    float speed = 1; //nodes per frame (chase); negative = reverse (chase, wipe)
+    float density = 0.1f; //fraction of nodes lit (twinkle, sparkle)
+    uint32_t seed = 0; //random pattern (twinkle, sparkle)
+    int blend = NORMAL; //how to combine with layers below
+    float opacity = 1; //0..1
+public: //helpers
+    static const char* name(int kind)
+    {
+        static const char* names[] = {"none", "fill", "gradient", "chase", "twinkle", "fade", "wipe", "rainbow", "sparkle"};
+        static_assert(sizeof(names) / sizeof(names[0]) == NUM_KINDS, "effect names out of sync");
+        return ((kind >= 0) && (kind < NUM_KINDS))? names[kind]: "??EFFECT??";
+    }
+    static int kind_of(const char* str)
+    {
+        for (int kind = 0; kind < NUM_KINDS; ++kind)
+            if (!strcmp(str, name(kind))) return kind;
+        return -1;
+    }
+    static const char* blend_name(int blend)
+    {
+        static const char* names[] = {"normal", "add", "max", "multiply", "alpha"};
+        static_assert(sizeof(names) / sizeof(names[0]) == NUM_BLENDS, "blend names out of sync");
+        return ((blend >= 0) && (blend < NUM_BLENDS))? names[blend]: "??BLEND??";
+    }
+    static int blend_of(const char* str)
+    {
+        for (int blend = 0; blend < NUM_BLENDS; ++blend)
+            if (!strcmp(str, blend_name(blend))) return blend;
+        return -1;
+    }
+//integer blend; frac 0..256 (0 = c1, 256 = c2):
+    static inline uint32_t lerp(uint32_t c1, uint32_t c2, unsigned int frac)
+    {
+        const unsigned int inv = 256 - frac;
+        return fromRGB((R(c1) * inv + R(c2) * frac) >> 8, (G(c1) * inv + G(c2) * frac) >> 8, (B(c1) * inv + B(c2) * frac) >> 8);
+    }
+//cheap stateless hash (lowbias32); same node + fr# always gives same result:
+    static inline uint32_t hash(uint32_t x)
+    {
+        x ^= x >> 16; x *= 0x7feb352d;
+        x ^= x >> 15; x *= 0x846ca68b;
+        return x ^ (x >> 16);
+    }
+public: //methods
+//render len nodes for fr#; caller applies brightness limit:
+    void render(uint32_t* __restrict dest, int len, int32_t frnum) const
+    {
+        const int32_t frames = std::max(frnum - start, 0); //time since cue started; hold first frame until then
+        const int cycle = std::max(period, 1);
+        const uint32_t threshold = (density >= 1)? UINT32_MAX: (density <= 0)? 0: (uint32_t)(density * UINT32_MAX);
+        switch (kind)
+        {
+            case FILL:
+                for (int i = 0; i < len; ++i) dest[i] = color;
+                break;
+            case GRADIENT:
+                for (int i = 0; i < len; ++i) dest[i] = lerp(color, color2, (len > 1)? i * 256 / (len - 1): 0);
+                break;
+            case CHASE:
+            {
+                const int step = std::max(period, 2); //nodes between lit nodes
+                const int shift = (int)floor(frames * speed) % step;
+                for (int i = 0; i < len; ++i) dest[i] = (((i - shift) % step + step) % step)? color2: color;
+                break;
+            }
+            case TWINKLE: //lit nodes ramp up and down once per period, each with its own phase
+                for (int i = 0; i < len; ++i)
+                {
+                    const uint32_t rnd = hash(seed ^ (i * 0x9E3779B1));
+                    const int t = (frames + (int)(rnd % cycle)) % cycle;
+                    const unsigned int tri = 256 - abs(2 * t - cycle) * 256 / cycle; //0..256..0
+                    dest[i] = (hash(rnd) <= threshold)? lerp(color2, color, tri): color2;
+                }
+                break;
+            case FADE: //color -> color2 over period frames, then hold
+            {
+                const uint32_t faded = lerp(color, color2, std::min(frames * 256 / cycle, 256));
+                for (int i = 0; i < len; ++i) dest[i] = faded;
+                break;
+            }
+            case WIPE: //color2 replaced by color over period frames
+            {
+                const int edge = std::min(frames * len / cycle, len);
+                for (int i = 0; i < len; ++i) dest[i] = (((speed < 0)? len - 1 - i: i) < edge)? color: color2;
+                break;
+            }
+            case RAINBOW: //1 full hue cycle across range, scrolling once per period (period 0 = static)
+            {
+                const double scroll = period? (double)(frames % period) / period: 0;
+                for (int i = 0; i < len; ++i)
+                {
+                    const double hue = (double)i / len + scroll;
+                    dest[i] = hsv2argb(hue - floor(hue), 1.0, 1.0);
+                }
+                break;
+            }
+            case SPARKLE: //random nodes lit each frame
+                for (int i = 0; i < len; ++i) dest[i] = (hash(seed ^ (i * 0x9E3779B1) ^ (frnum * 0x85EBCA6B)) <= threshold)? color: color2;
+                break;
+        }
+    }
+//composite rendered layer over dest; one pass per layer with the mode switch outside the loop:
+    void composite(uint32_t* __restrict dest, const uint32_t* __restrict src, int len) const
+    {
+        const unsigned int op = (opacity >= 1)? 256: (opacity <= 0)? 0: (unsigned int)(opacity * 256); //0..256
+        switch (blend)
+        {
+            case NORMAL:
+                for (int i = 0; i < len; ++i) dest[i] = lerp(dest[i], src[i], op);
+                break;
+            case ADD: //saturate
+                for (int i = 0; i < len; ++i) dest[i] = fromRGB(R(dest[i]) + (R(src[i]) * op >> 8), G(dest[i]) + (G(src[i]) * op >> 8), B(dest[i]) + (B(src[i]) * op >> 8));
+                break;
+            case MAX:
+                for (int i = 0; i < len; ++i) dest[i] = fromRGB(std::max(R(dest[i]), R(src[i]) * op >> 8), std::max(G(dest[i]), G(src[i]) * op >> 8), std::max(B(dest[i]), B(src[i]) * op >> 8));
+                break;
+            case MULTIPLY: //darken by src, then mix by opacity
+                for (int i = 0; i < len; ++i) dest[i] = lerp(dest[i], fromRGB(R(dest[i]) * R(src[i]) / 255, G(dest[i]) * G(src[i]) / 255, B(dest[i]) * B(src[i]) / 255), op);
+                break;
+            case ALPHA: //src A bits * opacity
+                for (int i = 0; i < len; ++i)
+                {
+                    const unsigned int a = A(src[i]) * op >> 8; //0..255
+                    dest[i] = lerp(dest[i], src[i], a + (a >> 7)); //0..256
+                }
+                break;
+        }
+    }
+public: //operators
+    STATIC friend std::ostream& operator<<(std::ostream& ostrm, const Effect& that)
+    {
+        ostrm << "{" << name(that.kind) << " univ " << that.univ << ", nodes " << that.ofs << "+" << that.count;
+        ostrm << ", colors 0x" << std::hex << that.color << "/0x" << that.color2 << std::dec << ", start " << that.start << ", period " << that.period;
+        ostrm << ", speed " << that.speed << ", density " << that.density << ", seed " << that.seed;
+        return ostrm << ", " << blend_name(that.blend) << " " << that.opacity << "}";
+    }
+};
+
+#endif //ndef _EFFECTS_H
+
+
+////////////////////////////////////////////////////////////////////////////////
+////
+/// unit test:
+//
+
+#ifdef WANT_UNIT_TEST
+#undef WANT_UNIT_TEST //prevent recursion
+
+#include "logging.h"
+#include "str-helpers.h"
+
+#include "effects.h"
+
+
+// application entry point
+//int main(int argc, const char* argv[])
+void unit_test(ARGS& args)
+{
+    uint32_t nodes[16];
+    Effect fx;
+    for (fx.kind = Effect::FILL; fx.kind < Effect::NUM_KINDS; ++fx.kind)
+    {
+        fx.period = 8;
+        fx.color = RED;
+        fx.render(nodes, SIZEOF(nodes), 3);
+        std::ostringstream ss;
+        for (int i = 0; i < SIZEOF(nodes); ++i) ss << " " << std::hex << (nodes[i] & 0xFFFFFF);
+        debug(0, "%s fr# 3:%s", Effect::name(fx.kind), ss.str().c_str());
+    }
+//blend modes, half-opacity red over blue:
+    uint32_t below, above = RED;
+    for (fx.blend = Effect::NORMAL; fx.blend < Effect::NUM_BLENDS; ++fx.blend)
+    {
+        below = BLUE;
+        fx.opacity = 0.5;
+        fx.composite(&below, &above, 1);
+        debug(0, "%s: 0x%x", Effect::blend_name(fx.blend), below & 0xFFFFFF);
+    }
+    debug(0, "done");
+//    return 0;
+}
+
+#endif //def WANT_UNIT_TEST
+
+//eof
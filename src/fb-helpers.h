@@ -24,6 +24,12 @@
 //#include <ctype.h> //isxdigit()
 //#include <sys/stat.h> //struct stat
 #include <time.h> //struct timespec
+#include <memory> //std::unique_ptr<>
+#include <thread> //std::thread
+#include <mutex> //std::mutex, std::unique_lock<>
+#include <condition_variable> //std::condition_variable
+#include <exception> //std::exception_ptr
+#include <map> //std::map<>
 #ifndef RPI_NO_X
  #include <X11/Xlib.h>
  #include <X11/extensions/xf86vmode.h> //XF86VidModeGetModeLine
@@ -95,6 +101,7 @@ public: //members/properties
     const /*auto*/ decltype(m_varinfo.xres)& width; //uint32_t
     const /*auto*/ decltype(m_varinfo.xres)& height; //uint32_t
     const /*auto*/ decltype(m_fixinfo.line_length)& pitch; //bytes; //uint32_t
+    const int screen; //fb device# (1 per screen/output)
 //    double hscale, vscale; //allow stetch
     inline /*decltype(m_varinfo.pixclock)*/ auto KHz() const { return PICOS2KHZ(m_varinfo.pixclock); } //psec => KHz
     inline size_t rowlen(int num_rows = 1) const { return num_rows * m_fixinfo.line_length / sizeof(PIXEL); } //bytes => uint32's
@@ -111,12 +118,14 @@ protected:
     bool m_cfg_dirty; //TODO: allow caller to change cfg?
 //    struct timespec m_started;
 public: //ctor/dtor
-    explicit FB(SrcLine srcline = 0): m_fd(-1), m_fbp((PIXEL*)-1), m_cfg_dirty(false), width(m_varinfo.xres), height(m_varinfo.yres), pitch(m_fixinfo.line_length), m_srcline(srcline), m_started(Now()) //, hscale(1), vscale(1)
+    explicit FB(int which = 0, SrcLine srcline = 0): m_fd(-1), m_fbp((PIXEL*)-1), m_cfg_dirty(false), width(m_varinfo.xres), height(m_varinfo.yres), pitch(m_fixinfo.line_length), screen(which), m_srcline(srcline), m_started(Now()) //, hscale(1), vscale(1)
     {
 //HERE(1);
 //open fb device for read/write:
-        m_fd = ::open("/dev/fb0", O_RDWR);
-        if (!m_fd || (m_fd == -1)) exc_hard("Error: cannot open framebuffer device");
+        char devname[24];
+        snprintf(devname, sizeof(devname), "/dev/fb%d", screen); //each screen/output has its own fb device and vsync
+        m_fd = ::open(devname, O_RDWR);
+        if (!m_fd || (m_fd == -1)) exc_hard("Error: cannot open framebuffer device %s", devname);
 //store config for quick access and in case caller changes it and wants to revert:
         if (ioctl(m_fd, FBIOGET_FSCREENINFO, &m_fixinfo) == -1) exc_hard("Error reading fixed info");
         if (ioctl(m_fd, FBIOGET_VSCREENINFO, &m_varinfo) == -1) exc_hard("Error reading variable info");
@@ -130,7 +139,7 @@ public: //ctor/dtor
             int num_screens = display.get()? ScreenCount(display.get()/*.cast*/): 0;
             debug(30, "got disp %p, #screens: %d" << ATLINE(srcline), display.get(), num_screens);
 //            int dot_clock;
-            for (int i = 0; i < num_screens; ++i)
+            for (int i = screen; i < num_screens; ++i)
             {
                 int dot_clock; //, mode_flags;
 //        XF86VidModeModeLine mode_line = {0};
@@ -433,8 +442,8 @@ public: //ctor/dtor
     struct NullOkay {}; //ctor disambiguation tag
     explicit FB_AutoTexture(NullOkay): width(m_view.w), height(m_view.h) { debug(20, "empty ctor"); m_view.w = m_view.h = 0; } //: m_started(now()), m_srcline(0) {}
 //    explicit FB_AutoTexture(FB_AutoTexture that): FB_AutoTexture(&that.view(), 0, SRCLINE) {} //used by create() retval
-    /*explicit*/ FB_AutoTexture(const FB_AutoTexture& that): FB_AutoTexture(&that.m_view, 0, SRCLINE) { debug(20, "copy ctor"); } //delegated; NOTE: needs to be implicit for NAMED create() and create()
-    explicit FB_AutoTexture(const FB_Size* view_wh = NO_SIZE, PXTYPE init_color = FB::BLACK, SrcLine srcline = 0): width(m_view.w), height(m_view.h), m_latest(Now()), m_started(Now()), m_srcline(srcline)
+    /*explicit*/ FB_AutoTexture(const FB_AutoTexture& that): FB_AutoTexture(&that.m_view, 0, SRCLINE, that.m_fb.screen) { debug(20, "copy ctor"); } //delegated; NOTE: needs to be implicit for NAMED create() and create()
+    explicit FB_AutoTexture(const FB_Size* view_wh = NO_SIZE, PXTYPE init_color = FB::BLACK, SrcLine srcline = 0, int screen = 0): m_fb(screen, srcline), width(m_view.w), height(m_view.h), m_latest(Now()), m_started(Now()), m_srcline(srcline)
     {
 //        m_fb.m_started = now(); m_fb.m_srcline = NVL(srcline, SRCLINE);
 //        m_hscale = view_wh? (double)m_fb.width / view_wh->w: 1;
@@ -445,7 +454,7 @@ public: //ctor/dtor
         clear(init_color, NVL(srcline, SRCLINE));
         INSPECT(GREEN_MSG << "ctor " << *this << ATLINE(srcline));
     }
-    /*virtual*/ ~FB_AutoTexture() { INSPECT(RED_MSG "dtor " << *this << ", lifespan " << (Now() - m_started) / 1000 /*m_started, 1000)*/ << " sec" << ATLINE(m_srcline)); }
+    /*virtual*/ ~FB_AutoTexture() { pipeline(false); INSPECT(RED_MSG "dtor " << *this << ", lifespan " << (Now() - m_started) / 1000 /*m_started, 1000)*/ << " sec" << ATLINE(m_srcline)); }
 public: //operators
     FB_AutoTexture& operator=(const FB_AutoTexture& that) //NOTE: FB itself doesn't need to be copied because it's just mmapped
     {
@@ -464,6 +473,7 @@ public: //operators
         if (!&that) return ostrm << " NO DATA}";
         ostrm << ", view " << that.m_view << " => scale " << that.hscale() << " x " << that.vscale() << ", group " << that.hgroup() << " x " << that.vgroup() << " => " << that.m_view.w * that.hgroup() << " x " << that.m_view.h * that.vgroup();
         ostrm << ", fb " << that.m_fb;
+        if (that.m_staging[0]) ostrm << ", pipelined";
         ostrm << "}";
         return ostrm; 
     }
@@ -483,10 +493,10 @@ public: //methods
     }
 //factory:
 //    FB_Size view() const { return FB_Size(m_fb.width / m_hscale, m_fb.height / m_vscale); }
-    static FB_AutoTexture/*& not allowed with rval ret; not needed with unique_ptr*/ create(const FB_Size* view_wh = NO_SIZE, PXTYPE init_color = FB::BLACK, SrcLine srcline = 0)
+    static FB_AutoTexture/*& not allowed with rval ret; not needed with unique_ptr*/ create(const FB_Size* view_wh = NO_SIZE, PXTYPE init_color = FB::BLACK, SrcLine srcline = 0, int screen = 0)
     {
 //        debug(0, "view@ %p " << *view_wh, view_wh);
-        return FB_AutoTexture(view_wh, init_color, srcline);
+        return FB_AutoTexture(view_wh, init_color, srcline, screen);
     }
 //updates:
 //clear => screen, fill => pixel buf
@@ -507,10 +517,46 @@ public: //methods
         m_fb.vsync(); //CAUTION: waits up to 1 frame time (~17 msec @60 FPS)
     }
     typedef std::function<void(void* dest, const void* src, size_t len)> XFR; //void* (*XFR)(void* dest, const void* src, size_t len); //NOTE: must match memcpy sig; //decltype(memcpy);
+//pipelined mode: caller encodes next frame into a staging buf while presenter thread waits for vsync and copies previous one to framebuf
+//encode time then overlaps scan-out instead of counting against frame budget; caller can get at most 1 frame ahead
+    void pipeline(bool enable, SrcLine srcline = 0)
+    {
+        if (enable == !!m_staging[0]) return; //no change
+        if (!enable)
+        {
+            { std::unique_lock<std::mutex> lock(m_pipemtx); m_pipestop = true; }
+            m_pipecv.notify_all();
+            if (m_presenter.joinable()) m_presenter.join();
+            m_staging[0].reset(); m_staging[1].reset();
+            return;
+        }
+        for (auto& buf: m_staging) buf.reset(new PXTYPE[m_view.w * m_view.h]());
+        m_pending = -1; m_back = 0; m_pipestop = false; m_pipexc = nullptr;
+        m_presenter = std::thread(&FB_AutoTexture::presenter, this); //NOTE: inherits caller's sched policy + affinity
+        debug(20, "pipelined: 2 x " << m_view << " staging bufs" << ATLINE(srcline));
+    }
     void update(const PXTYPE* pixels, /*const SDL_Rect* rect = NO_RECT,*/ elapsed_t* perf = NO_PERF, XFR xfr = NO_XFR, /*REFILL refill = NO_REFILL,*/ SrcLine srcline = 0)
     {
         if (!perf) perf = &perf_stats[0];
         perf[CALLER] += perftime(); //time caller spent rendering (sec); could be long (caller determines)
+        if (m_staging[0]) //pipelined; presenter thread does vsync + stretch
+        {
+            if (!pixels) return;
+            if (!xfr) exc_hard("no xfr cb");
+            xfr(m_staging[m_back].get(), pixels, m_view.w * m_view.h * sizeof(PXTYPE)); //render/pivot into back staging buf
+            perf[CPU_TXTR] += perftime(); //1000); //CPU-side data xfr time (msec)
+            std::unique_lock<std::mutex> lock(m_pipemtx);
+            m_pipecv.wait(lock, [this]{ return (m_pending < 0) || m_pipestop; }); //wait for presenter to take previous buf
+            if (m_pipexc) std::rethrow_exception(m_pipexc); //presenter died; let caller deal with it
+            m_pending = m_back; m_back ^= 1;
+            m_presented = m_pipe_presented; //previous buf is on screen now
+            perf[NUM_PRESENT] += m_pipe_numpresent; m_pipe_numpresent = 0; //fold presenter stats into caller's on caller's thread
+            perf[REND_PRESENT] += m_pipe_presenttime; m_pipe_presenttime = 0;
+            lock.unlock();
+            m_pipecv.notify_all();
+            perf[REND_COPY] += perftime(); //time waiting for presenter; > 0 means encode is faster than frame rate
+            return;
+        }
         if (pixels)
         {
             size_t xfrlen = m_view.w * m_view.h * sizeof(PXTYPE); //m_fb.width * m_fb.height / m_hscale / m_vscale;
@@ -523,12 +569,51 @@ public: //methods
         ++perf[NUM_PRESENT]; //#render presents
         perf[REND_PRESENT] += perftime(); //1000); //vsync wait time (idle time, in msec); should align with fps
     }
+public: //pipeline status
+    bool pipelined() const { return !!m_staging[0]; }
+//pipelined update() returns at hand-off, so m_latest is not a present time; this is when the previous buf was actually presented:
+    elapsed_t presented() const { return m_presented; }
 protected: //helpers
+    void presenter()
+    {
+        try
+        {
+            for (;;)
+            {
+                int front;
+                {
+                    std::unique_lock<std::mutex> lock(m_pipemtx);
+                    m_pipecv.wait(lock, [this]{ return (m_pending >= 0) || m_pipestop; });
+                    if (m_pipestop) break;
+                    front = m_pending;
+                }
+                decltype(Now()) started = Now();
+                m_fb.vsync(); //CAUTION: waits up to 1 frame time (~17 msec @60 FPS)
+                decltype(Now()) vsynced = Now(); //present time (same point as m_latest in non-pipelined update)
+                stretch(m_staging[front].get()); //copy + stretch to fill entire framebuf
+                {
+                    std::unique_lock<std::mutex> lock(m_pipemtx);
+                    m_pipe_presented = vsynced;
+                    ++m_pipe_numpresent; //#render presents; caller's perf stats are only touched by caller's thread
+                    m_pipe_presenttime += Now() - started; //vsync wait + copy time
+                    m_pending = -1; //staging buf can be reused
+                }
+                m_pipecv.notify_all();
+            }
+        }
+        catch (...)
+        {
+            std::unique_lock<std::mutex> lock(m_pipemtx);
+            m_pipexc = std::current_exception(); //rethrow on caller's thread
+            m_pending = -1;
+            m_pipecv.notify_all();
+        }
+    }
     double hscale() const { return (double)m_view.w / m_fb.width; }
     double vscale() const { return (double)m_view.h / m_fb.height; }
     int hgroup() const { return rdiv(m_fb.width, m_view.w); } //NOTE: a little x overscan is okay (want 1/3 pixel h overscan)
     int vgroup() const { return rdiv(m_fb.height, m_view.h); } //don't want v overscan (only affects univ tails so probably doesn't matter)
-    void stretch()
+    void stretch(const PXTYPE* srcp = 0) //src defaults to packed view at start of framebuf
     {
 //        if (m_vscale == 1) //horizontal stretch only
 //        FB::PIXEL* pbp = &m_fb[0];
@@ -537,6 +622,7 @@ protected: //helpers
 //                if (viewy != y) memcpy(&m_fb[m_fb.xy()]
 //        double hreduce = hscale(), vreduce = vscale();
         FB::PIXEL* framep = &m_fb[0];
+        if (!srcp) srcp = framep;
         if (!m_view.w || !m_view.h) return;
 static int count = 0;
 bool want_debug = !count++;
@@ -559,7 +645,7 @@ bool want_debug = !count++;
 //                    commas(srcxy), commas(srcxy - (m_view.w - 1) * rptx), commas(rowp - framep + destx +i), commas());
                 if (want_debug) debug(50, "col[%s]? %d, copy [%s] to %s..%s", commas(destx / rptx), destx < m_fb.width,
                     commas(srcxy), commas(desty * rowlen + destx), commas(desty * rowlen + destx + std::min(rptx, (int)m_fb.width - destx) - 1));
-                for (int i = 0; (i < rptx) && (i < m_fb.width - destx); ++i) rowp[destx + i] = framep[srcxy]; //horizontal stretch
+                for (int i = 0; (i < rptx) && (i < m_fb.width - destx); ++i) rowp[destx + i] = srcp[srcxy]; //horizontal stretch
             }
             if (want_debug) debug(50, "row[%s]? %d, copy [%s] to %s..%s", commas(desty / rpty), desty < m_fb.height,
                 commas(desty * rowlen), commas((desty + 1) * rowlen), commas((desty + std::min(rpty, (int)m_fb.height - desty) - 1) * rowlen));
@@ -599,7 +685,7 @@ public: //named arg variants
 //            int& h = size.h;
 //            SDL_Format fmt = NO_FORMAT;
 //            SDL_TextureAccess access = NO_ACCESS;
-            int screen = 0; //FIRST_SCREEN; //not used
+            int screen = 0; //FIRST_SCREEN; //fb device#
             PXTYPE init_color = FB::BLACK;
             SrcLine srcline = 0;
         } params;
@@ -607,7 +693,7 @@ public: //named arg variants
         unpack(params, named_params);
         if (params.view_wh) { sv_wh = *params.view_wh; params.view_wh = &sv_wh; } //kludge: copy wh in case callee used a temp
 //        debug(0, "view@ %p " << *params.view_wh, params.view_wh);
-        return create(params.view_wh, params.init_color, params.srcline);
+        return create(params.view_wh, params.init_color, params.srcline, params.screen);
     }
     template <typename CALLBACK>
     inline auto update(CALLBACK&& named_params)
@@ -639,6 +725,16 @@ protected:
     static STATIC_WRAP(std::string, my_templargs, = TEMPL_ARGS);
     /*FB::elapsed_t*/ decltype(Now()) m_started;
     SrcLine m_srcline; //save for parameter-less methods (dtor, etc)
+//pipeline state (not copied):
+    std::unique_ptr<PXTYPE[]> m_staging[2]; //double-buffered encoded frames
+    int m_pending = -1, m_back = 0; //staging buf# waiting for presenter (-1 = none), buf# caller encodes into next
+    bool m_pipestop = false;
+    elapsed_t m_pipe_presented = 0, m_pipe_numpresent = 0, m_pipe_presenttime = 0; //set by presenter (under m_pipemtx), picked up by next update()
+    elapsed_t m_presented = 0; //caller's copy of m_pipe_presented
+    std::exception_ptr m_pipexc;
+    std::mutex m_pipemtx;
+    std::condition_variable m_pipecv;
+    std::thread m_presenter;
 };
 
 
@@ -660,7 +756,7 @@ typedef uint32_t Uint32;
 #define SDL_Size  FB_Size
 #define SDL_AutoTexture  FB_AutoTexture
 #define SDL_QuitRequested()  false
-#define FIRST_SCREEN  0 //ignored
+#define FIRST_SCREEN  0 //= /dev/fb0
 
 
 struct FB_DisplayMode
@@ -678,9 +774,9 @@ struct FB_DisplayMode
         return ostrm << that.wh;
     }
 //ctors/dtors:
-    FB_DisplayMode()
+    explicit FB_DisplayMode(int screen = FIRST_SCREEN)
     {
-        FB fb;
+        FB fb(screen);
         bounds.x = bounds.y = 0;
         bounds.w = wh.w = fb.width;
         bounds.h = wh.h = fb.height;
@@ -690,8 +786,12 @@ struct FB_DisplayMode
 
 const FB_DisplayMode* ScreenInfo(int screen = FIRST_SCREEN, SrcLine srcline = 0)
 {
-    static FB_DisplayMode dm;
-    return &dm;
+    static std::mutex mtx; //gpu wkers for different ports can call this at the same time
+    static std::map<int, std::unique_ptr<FB_DisplayMode>> dm; //1 per screen; cached because screen info won't change
+    std::lock_guard<std::mutex> lock(mtx);
+    std::unique_ptr<FB_DisplayMode>& ptr = dm[screen];
+    if (!ptr) ptr.reset(new FB_DisplayMode(screen));
+    return ptr.get();
 }
 
 
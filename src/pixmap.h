@@ -0,0 +1,154 @@
+//pixel mapping:
+//maps a model-space frame buffer (2D matrix, 3D shape, etc) to univ/node positions in the node buffer
+//mapping is kept as runs of consecutive nodes, so most of it is straight (or reversed) copies instead of per-node lookups
+
+//layout file format (text, 1 run per line; "#" starts a comment):
+//  univ  node  count  pixel  [step]
+//copies count model pixels starting at pixel (stepping by step, default 1) into univ starting at node
+//reversed strings use step -1; zig-zag matrix rows alternate +1 and -1
+
+#if !defined(_PIXMAP_H) && !defined(WANT_UNIT_TEST) //force unit test to explicitly #include this file
+#define _PIXMAP_H //CAUTION: put this before defs to prevent loop on cyclic #includes
+
+#include <stdint.h> //uint*_t
+#include <stdio.h> //fopen(), fgets(), sscanf()
+#include <string.h> //strchr()
+#include <vector> //std::vector<>
+#include <algorithm> //std::sort()
+#include <string> //std::string
+
+
+class PixelMap
+{
+public:
+    struct Run
+    {
+        int univ, node, count; //destination
+        int pixel, step; //source
+    };
+    std::vector<Run> runs; //sorted by univ, node
+    int numpixels = 0; //model size needed (max pixel + 1)
+public: //methods
+//build from a lookup table: table[pixel] = univ * 0x10000 + node, or -1 if pixel is not mapped:
+    void build(const int32_t* table, size_t len)
+    {
+        runs.clear();
+        numpixels = 0;
+        for (size_t i = 0; i < len; ++i)
+        {
+            if (table[i] < 0) continue;
+            const int univ = table[i] >> 16, node = table[i] & 0xFFFF;
+            numpixels = i + 1;
+            if (!runs.empty())
+            {
+                Run& prev = runs.back();
+                const int step = (int)i - ((prev.step == 1)? prev.pixel + prev.count - 1: prev.pixel); //distance from highest pixel in run
+                if ((prev.univ == univ) && (prev.node + prev.count == node) && (step == 1) && ((prev.count == 1) || (prev.step == 1))) { prev.step = 1; ++prev.count; continue; } //forward
+                if ((prev.univ == univ) && (prev.node - 1 == node) && (step == 1) && ((prev.count == 1) || (prev.step == -1))) { prev.step = -1; --prev.node; prev.pixel = i; ++prev.count; continue; } //reversed string
+            }
+            runs.push_back({univ, node, 1, (int)i, 1});
+        }
+        sort();
+    }
+//load from layout file; returns error msg or empty string:
+    std::string load(const char* path)
+    {
+        FILE* fp = fopen(path, "r");
+        if (!fp) return std::string("can't open ") + path;
+        std::vector<Run> newruns;
+        int newpixels = 0, linenum = 0;
+        char buf[256], errbuf[300];
+        while (fgets(buf, sizeof(buf), fp))
+        {
+            ++linenum;
+            char* cmt = strchr(buf, '#');
+            if (cmt) *cmt = '\0';
+            Run run = {0, 0, 0, 0, 1};
+            const int numval = sscanf(buf, "%d %d %d %d %d", &run.univ, &run.node, &run.count, &run.pixel, &run.step);
+            if (numval <= 0) continue; //blank line
+            const int last = run.pixel + (run.count - 1) * run.step;
+            if ((numval < 4) || (run.univ < 0) || (run.node < 0) || (run.count <= 0) || (run.pixel < 0) || (last < 0))
+            {
+                snprintf(errbuf, sizeof(errbuf), "%s:%d: bad run '%s' (expected univ node count pixel [step])", path, linenum, buf);
+                fclose(fp);
+                return errbuf;
+            }
+            newpixels = std::max(newpixels, std::max(run.pixel, last) + 1);
+            newruns.push_back(run);
+        }
+        fclose(fp);
+        runs.swap(newruns);
+        numpixels = newpixels;
+        sort();
+        return "";
+    }
+//check that all runs fit in node buffer; returns index of first bad run or -1:
+    int check(int numuniv, int univlen) const
+    {
+        for (size_t i = 0; i < runs.size(); ++i)
+            if ((runs[i].univ >= numuniv) || (runs[i].node + runs[i].count > univlen)) return i;
+        return -1;
+    }
+//copy model pixels into node buffer; rows are univlen apart; returns bitmap of univ touched, using caller's bit order (univ_bit(x) = bit for univ x):
+    template <typename COLOR = uint32_t, typename MASK = uint32_t, typename UNIVBIT>
+    MASK scatter(COLOR* nodes, size_t univlen, const COLOR* __restrict model, UNIVBIT&& univ_bit) const
+    {
+        MASK bits = 0;
+        for (const Run& run: runs)
+        {
+            COLOR* __restrict dest = nodes + run.univ * univlen + run.node;
+            const COLOR* src = model + run.pixel;
+            if (run.step == 1) std::copy(src, src + run.count, dest); //memcpy
+            else if (run.step == -1) std::reverse_copy(src - run.count + 1, src + 1, dest);
+            else for (int i = 0; i < run.count; ++i) dest[i] = src[i * run.step];
+            bits |= univ_bit(run.univ);
+        }
+        return bits;
+    }
+private: //helpers
+    void sort() { std::sort(runs.begin(), runs.end(), [](const Run& lhs, const Run& rhs) { return (lhs.univ != rhs.univ)? (lhs.univ < rhs.univ): (lhs.node < rhs.node); }); } //write nodes in memory order
+};
+
+#endif //ndef _PIXMAP_H
+
+
+////////////////////////////////////////////////////////////////////////////////
+////
+/// unit test:
+//
+
+#ifdef WANT_UNIT_TEST
+#undef WANT_UNIT_TEST //prevent recursion
+
+#include "logging.h"
+#include "str-helpers.h"
+
+#include "pixmap.h"
+
+
+// application entry point
+//int main(int argc, const char* argv[])
+void unit_test(ARGS& args)
+{
+//4 x 3 zig-zag matrix on univ 1 + 2 reversed pixels on univ 0:
+    int32_t table[4 * 3 + 2];
+    for (int y = 0, i = 0; y < 3; ++y)
+        for (int x = 0; x < 4; ++x, ++i)
+            table[i] = 0x10000 + y * 4 + ((y & 1)? 3 - x: x);
+    table[12] = 5; table[13] = 4;
+    PixelMap pixmap;
+    pixmap.build(table, SIZEOF(table));
+    for (auto& run: pixmap.runs) debug(0, "run: univ %d, node %d, count %d, pixel %d, step %d", run.univ, run.node, run.count, run.pixel, run.step);
+    uint32_t model[SIZEOF(table)], nodes[2][16] = {0};
+    for (int i = 0; i < SIZEOF(model); ++i) model[i] = 100 + i;
+    uint32_t bits = pixmap.scatter(&nodes[0][0], SIZEOF(nodes[0]), model, [](int x) { return 0x800000 >> x; }); //univ 0 = MSB, like GpuPort ready bits
+    std::ostringstream ss;
+    for (int i = 0; i < 12; ++i) ss << " " << nodes[1][i];
+    debug(0, "%d runs, %d pixels, bits 0x%x, univ 0 nodes 4..5: %d %d, univ 1:%s", pixmap.runs.size(), pixmap.numpixels, bits, nodes[0][4], nodes[0][5], ss.str().c_str());
+    debug(0, "done");
+//    return 0;
+}
+
+#endif //def WANT_UNIT_TEST
+
+//eof
@@ -4,6 +4,7 @@
 #define _COLOR_HELPERS_H //CAUTION: put this before defs to prevent loop on cyclic #includes
 
 #include <map>
+#include <cmath> //floor(), std::isfinite()
 
 
 #ifndef pct
@@ -176,6 +177,91 @@ COLOR limit(COLOR color)
     return color;
 }
 
+//limit brightness of an array of colors (in place if dest == src):
+//uses a reciprocal LUT (one per sum of R+G+B) instead of 3 divides per reduced color; results match limit<>() exactly
+//24-bit fractions are rounded up, so the error is < 1/765 and never changes the rounded result; products still fit in 32 bits
+//NOTE: A bits are dropped/ignored on reduced colors, same as limit<>()
+class LimitLUT
+{
+    uint32_t m_recip[3 * 255 + 1]; //BRIGHTEST / sum, 8.24 fixed point; 0 for sums that don't need limiting
+public:
+    const int brightest; //max R+G+B
+    explicit LimitLUT(int maxbright = pct(50/60)): brightest((!maxbright || (maxbright >= 100))? 3 * 255: 3 * 255 * maxbright / 100)
+    {
+        for (int sum = 0; sum < 3 * 255 + 1; ++sum)
+            m_recip[sum] = (sum > brightest)? ((uint64_t)brightest << 24) / sum + !!(((uint64_t)brightest << 24) % sum): 0;
+    }
+public:
+    template <typename COLOR = uint32_t>
+    void operator()(COLOR* dest, const COLOR* src, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const COLOR color = src[i];
+            const unsigned int r = R(color), g = G(color), b = B(color);
+            const unsigned int sum = r + g + b; //max = 3 * 255 = 765
+            if (sum <= brightest) { dest[i] = color; continue; } //most colors
+            const uint32_t k = m_recip[sum];
+            dest[i] = (((r * k + (1 << 23)) >> 24) * Rshift) | (((g * k + (1 << 23)) >> 24) * Gshift) | (((b * k + (1 << 23)) >> 24) * Bshift);
+        }
+    }
+    template <typename COLOR = uint32_t>
+    inline void operator()(COLOR* colors, size_t count) const { (*this)(colors, colors, count); }
+};
+
+
+//batch color converters:
+//plain loops over flat arrays with selects instead of branches, so -O3 can auto-vectorize them
+//output is ARGB (A = 255); caller applies brightness limit afterward (see LimitLUT)
+
+//HSV -> ARGB; h, s, v are 0..1 (h wraps, s and v are clamped); same results as hsv2rgb() in index.js for in-range values
+template <typename COLOR = uint32_t>
+inline COLOR hsv2argb(double h, double s, double v)
+{
+    h = std::isfinite(h)? h - floor(h): 0; //[0..1]; negative or NaN must not reach unsigned conversions below
+    s = (s > 0)? (s < 1)? s: 1: 0; //also maps NaN to 0
+    v = (v > 0)? (v < 1)? v: 1: 0; //v > 1 would spill into next color byte
+    h *= 6; //[0..6]
+    const unsigned int segment = (h > 0)? (unsigned int)h: 0;
+    const double angle = (segment & 1)? h - segment: 1 - (h - segment); //fractional part
+    const unsigned int p = (unsigned int)((v * (1.0 - s)) * 0xff);
+    const unsigned int qt = (unsigned int)((v * (1.0 - (s * angle))) * 0xff);
+    const unsigned int vv = (unsigned int)(v * 0xff);
+//segment: 0 = [v, t, p], 1 = [q, v, p], 2 = [p, v, t], 3 = [p, q, v], 4 = [t, p, v], 5 = [v, p, q]; >= 6 same as 0
+    const unsigned int r = ((segment == 1) || (segment == 4))? qt: ((segment == 2) || (segment == 3))? p: vv;
+    const unsigned int g = ((segment == 1) || (segment == 2))? vv: ((segment == 4) || (segment == 5))? p: qt;
+    const unsigned int b = ((segment == 3) || (segment == 4))? vv: ((segment == 2) || (segment == 5))? qt: p;
+    return (255 * Ashift) | (r * Rshift) | (g * Gshift) | (b * Bshift);
+}
+//interleaved h, s, v triplets:
+template <typename COLOR = uint32_t>
+void hsv2argb(COLOR* __restrict dest, const float* __restrict hsv, size_t count)
+{
+    for (size_t i = 0; i < count; ++i, hsv += 3)
+        dest[i] = hsv2argb<COLOR>(hsv[0], hsv[1], hsv[2]);
+}
+
+//float RGB -> ARGB; interleaved r, g, b triplets 0..1 (clamped, rounded):
+template <typename COLOR = uint32_t>
+void rgbf2argb(COLOR* __restrict dest, const float* __restrict rgb, size_t count)
+{
+    for (size_t i = 0; i < count; ++i, rgb += 3)
+    {
+        const unsigned int r = clamp(rgb[0], 0.0f, 1.0f) * 255 + 0.5f, g = clamp(rgb[1], 0.0f, 1.0f) * 255 + 0.5f, b = clamp(rgb[2], 0.0f, 1.0f) * 255 + 0.5f;
+        dest[i] = (255 * Ashift) | (r * Rshift) | (g * Gshift) | (b * Bshift);
+    }
+}
+
+//palette index -> ARGB; out-of-range indexes give BLACK
+//NOTE: this is a gather, so it doesn't vectorize on NEON; limit the palette first rather than every output color
+template <typename INDEX, typename COLOR = uint32_t>
+void palette2argb(COLOR* __restrict dest, const INDEX* __restrict inx, size_t count, const COLOR* __restrict palette, size_t palsize)
+{
+    for (size_t i = 0; i < count; ++i)
+        dest[i] = (inx[i] < palsize)? palette[inx[i]]: BLACK;
+}
+
+
 //const uint32_t PALETTE[] = {RED, GREEN, BLUE, YELLOW, CYAN, MAGENTA, WHITE};
 
 //readable names (mainly for debug msgs):
@@ -218,6 +304,30 @@ void unit_test(ARGS& args)
     debug(0, "75%% 256 = 0x" << std::hex << dim(0.75, 256) << ", 25%% 256 0x" << dim(0.25, 256) << std::dec);
     debug(0, "75%% white = 0x" << std::hex << dimARGB(0.75, WHITE) << ", 25%% white 0x" << dimARGB(0.25, WHITE) << std::dec);
 
+//LUT limiter must match scalar limit<>():
+    static const int STEP = 3; //check every 3rd value of each color element; ~ 1/2 M colors
+    static const int NUMSTEPS = (256 + STEP - 1) / STEP;
+    static uint32_t colors[NUMSTEPS * NUMSTEPS * NUMSTEPS], limited[SIZEOF(colors)];
+    size_t numcolors = 0, mismatch = 0;
+    for (int r = 0; r < 256; r += STEP)
+        for (int g = 0; g < 256; g += STEP)
+            for (int b = 0; b < 256; b += STEP)
+                colors[numcolors++] = fromRGB(r, g, b);
+    uint32_t started = Now();
+    LimitLUT()(limited, colors, numcolors);
+    int lut_msec = Now() - started;
+    started = Now();
+    for (size_t i = 0; i < numcolors; ++i)
+        if ((limited[i] & 0xFFFFFF) != (limit<>(colors[i]) & 0xFFFFFF)) ++mismatch;
+    int scalar_msec = Now() - started; //includes compare
+    debug(0, "limit LUT vs. limit<>: %s colors, %s mismatch, %d msec vs. %d msec", commas(numcolors), commas(mismatch), lut_msec, scalar_msec);
+
+//batch converters:
+    const float hsv[] = {0, 1, 1, 1/3.0, 1, 1, 2/3.0, 1, 1, 1, 1, 1};
+    uint32_t argb[SIZEOF(hsv) / 3];
+    hsv2argb(argb, hsv, SIZEOF(argb));
+    debug(0, "hsv2argb red 0x%x, green 0x%x, blue 0x%x, wrap 0x%x", argb[0], argb[1], argb[2], argb[3]);
+
     debug(0, "done");
 //    return 0; 
 }
@@ -100,6 +100,10 @@ bool isRPi()
 //vcgencmd version
 //vcgencmd hdmi_timings  #https://www.raspberrypi.org/documentation/configuration/config-txt/video.md
 
+#ifndef MAX_SCREENS
+ #define MAX_SCREENS  4 //#screens/outputs to keep config for (dual HDMI, DPI + HDMI, etc)
+#endif
+
 //central timing parameters:
 //xres + yres (including front porch + sync + back porch) and pixel clock determine all other timing
 /*typedef*/ struct ScreenConfig
@@ -184,7 +188,10 @@ bool isRPi()
  bool read_config(int which, ScreenConfig* cfg, SrcLine srcline = 0)
  {
 //    cfg->screen = -1;
-    if (which) { exc_soft("TODO: get screen#%d config" << ATLINE(srcline), which); return false; }
+    char prefix[24]; //2nd HDMI output (RPi4) uses "hdmi_timings:1="
+    if (which) snprintf(prefix, sizeof(prefix), "hdmi_timings:%d=", which);
+    else strcpy(prefix, "hdmi_timings=");
+    const size_t prelen = strlen(prefix);
     int lines = 0;
     std::string str; 
     std::ifstream file("/boot/config.txt"); //TODO: read from memory; config file could have multiple (conditional) entries
@@ -244,7 +251,8 @@ bool isRPi()
 //HDMI_ASPECT_15_9 = 6  
 //HDMI_ASPECT_21_9 = 7  
 //HDMI_ASPECT_64_27 = 8  
-        int num_found = sscanf(str.c_str(), "hdmi_timings=%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d",
+        if (str.compare(0, prelen, prefix)) continue; //not for this screen
+        int num_found = sscanf(str.c_str() + prelen, "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d",
             &cfg->hdisplay, //&h_active_pixels, //horizontal pixels (width)
             &h_sync_polarity, //invert hsync polarity
             &cfg->hlead, //&h_front_porch, //horizontal forward padding from DE acitve edge
@@ -423,7 +431,9 @@ static void deleter(SDL_Window* ptr)
 
 const ScreenConfig* getScreenConfig(int which = 0, SrcLine srcline = 0) //ScreenConfig* scfg) //XF86VidModeGetModeLine* mode_line)
 {
-    static ScreenConfig cached; //NOTE: doesn't need to be thread_local; only one (bkg) thread should be calling this
+    static ScreenConfig cache[MAX_SCREENS]; //1 per screen; each port's gpu wker reads its own entry
+    if ((which < 0) || (which >= MAX_SCREENS)) { error("video[%d] out of range; max %d" << ATLINE(srcline), which, MAX_SCREENS - 1); return NULL; }
+    ScreenConfig& cached = cache[which];
     if (cached.screen == which) return &cached; //return cached data; screen info won't change
     if (!read_config(which, &cached, srcline))
     {
@@ -36,17 +36,19 @@
 
 #include <cstdlib> //atexit()
 #include <sys/shm.h> //shmctl(), shmget(), shmat(), shmdt(), shmid_ds
-//TODO: convert to Posix shm api:
-//#include <sys/mman.h> //shm_*()
-//#include <sys/stat.h> //mode consts
-//#include <fcntl.h> //O_* consts
+//Posix shm api (optional backend, see shm_opts below):
+#include <sys/mman.h> //shm_*(), mmap(), mlock(), madvise()
+#include <sys/stat.h> //mode consts, fstat()
+#include <fcntl.h> //O_* consts
+#include <atomic> //std::atomic<>
 #include <stdexcept> //std::runtime_error
 #include <cstring> //strerror()
 #include <stdint.h> //uint*_t
 #include <unistd.h> //sysconf()
 #include <errno.h>
 //#include <vector>
-//#include <mutex>
+#include <list> //std::list<>
+#include <mutex> //std::mutex, std::lock_guard<>
 //#include <type_traits> //std::remove_const<>
 
 //#include "msgcolors.h" //*_MSG, ENDCOLOR_*
@@ -109,7 +111,7 @@ const int SHM_LEVEL = 75; //detailed low-level debug level
 //uses 24 bytes on Intel, 16 bytes on ARM (Rpi)
 //#define SHM_MAGIC  0xfeedbeef //marker to detect valid shmem block
 //#define SHM_LOCAL  -33 //kludge: use local alloc instead of shm
-struct ShmHdr //16 or 24 bytes (depending on processor architecture)
+struct ShmHdr //24 or 40 bytes (depending on processor architecture)
 {
 //    int id; key_t key;
 //    template<bool SHARED_inner = SHARED>
@@ -121,6 +123,8 @@ struct ShmHdr //16 or 24 bytes (depending on processor architecture)
     size_t size;
     size_t numents; //allows dtor loop in type-safe shmfree
     void* usrptr; //allows hdr lookup from heap
+    size_t maplen; //Posix only: mapped len (includes trailer)
+    int opts; //backend + options actually applied (see ShmOpts)
     uint32_t marker;
     static const int SHM_LOCAL = 0xfacade; //-33; //kludge: use local alloc instead of shm
     static const int SHM_VALID = 0xfeedbeef; //marker to detect valid shmem block
@@ -146,7 +150,19 @@ struct WithShmHdr
 #ifdef SHMHDR_IN_HEAP
  #define IFHEAPHDR_1ARG(stmt)  stmt
  #define IFHEAPHDR_2ARGS(yes_stmt, no_stmt)  yes_stmt
- vector_cxx17<ShmHdr> hdrs; //store hdrs in heap; owner is only proc that needs info anyway; linear search ok for small counts
+ vector_cxx17<ShmHdr, std::list<ShmHdr>> hdrs; //store hdrs in heap; owner is only proc that needs info anyway; linear search ok for small counts; list so hdr ptrs stay valid while other threads add/remove
+ std::mutex hdrs_mtx; //hdrs are shared by all Node envs (main + worker_threads) within a proc
+ ShmHdr* new_shmhdr()
+ {
+    std::lock_guard<std::mutex> lock(hdrs_mtx);
+    return &hdrs.emplace_back();
+ }
+ void del_shmhdr(const ShmHdr* hdrptr)
+ {
+    std::lock_guard<std::mutex> lock(hdrs_mtx);
+    for (auto it = hdrs.begin(); it != hdrs.end(); ++it)
+        if (&*it == hdrptr) { hdrs.erase(it); return; }
+ }
 #else
  #define IFHEAPHDR_1ARG(stmt)  //noop
  #define IFHEAPHDR_2ARGS(yes_stmt, no_stmt)  no_stmt
@@ -154,6 +170,14 @@ struct WithShmHdr
 #define IFHEAPHDR(...)  UPTO_2ARGS(__VA_ARGS__, IFHEAPHDR_2ARGS, IFHEAPHDR_1ARG) (__VA_ARGS__)
 
 
+//shm backend selection:
+//SysV is the default (compatible with "ipcs -m" and existing external readers)
+//Posix shm_open + mmap allows huge pages (fewer TLB misses), mlock (no paging under memory pressure) and pre-faulting (no first-touch page faults during playback)
+//CAUTION: select before first shmalloc(); existing allocations keep their own backend
+enum ShmOpts: int { SHM_SYSV = 0, SHM_POSIX = 1, SHM_HUGEPAGE = 2, SHM_MLOCK = 4, SHM_PREFAULT = 8, SHM_HUGETLBFS = 0x100 }; //SHM_HUGETLBFS is set by shmalloc() only
+int shm_opts = SHM_SYSV;
+
+
 //check if mem ptr is valid:
 //template <bool IPC>
 //static MemHdr<IPC>* memptr(void* addr, const char* func)
@@ -168,9 +192,12 @@ const ShmHdr* get_shmhdr(const void* addr, SrcLine srcline = 0)
 //    for (auto it = hdrs.begin(); it != hdrs.end(); ++it)
 //    for (auto& it: hdrs)
 //        debug(SHM_LEVEL, BLUE_MSG "hdr[%d]: addr %p, size %u, match? %d" ENDCOLOR, &it - &hdrs[0], it.usrptr, it.size, it.usrptr == addr);
-    for (auto& it: hdrs)
+    { //scope for lock; don't hold it while throwing
+        std::lock_guard<std::mutex> lock(hdrs_mtx);
+        for (auto& it: hdrs)
 //    for (auto it = hdrs.begin(); it != hdrs.end(); ++it)
-        if (it.usrptr == addr) return &it;
+            if (it.usrptr == addr) return &it;
+    }
 #else
     const ShmHdr* ptr = static_cast<const ShmHdr*>(addr);
 //    if (ptr-- && !((ptr->marker ^ SHM_MAGIC) & ~1)) return ptr;
@@ -191,6 +218,8 @@ const ShmHdr* get_shmhdr(const void* addr, SrcLine srcline = 0)
 //#define IFHDR(...)  UPTO_2ARGS(__VA_ARGS__, IFHDR_2ARGS, IFHDR_1ARG) (__VA_ARGS__)
 
 
+void* shmalloc_posix(size_t size, key_t key, SrcLine srcline = 0); //fwd ref
+
 //allocate shm:
 //TODO: use ftok?
 //NOTE: same shm seg can be attached at multiple addresses within same proc
@@ -205,17 +234,20 @@ void* shmalloc(size_t size, key_t key = 0, /*bool* existed = 0,*/ SrcLine srclin
 //    bool dummy;
 //    if (!existed) existed = &dummy;
     if (!key) key = (rand() << 16) | 0xbeef; //generate new (pseudo-random) key
+    if ((shm_opts & SHM_POSIX) && (key != ShmHdr::SHM_LOCAL)) return shmalloc_posix(size, key, srcline);
     ShmHdr* hdrptr;
     const int extralen = IFHEAPHDR(0, sizeof(ShmHdr));
     if (key == ShmHdr::SHM_LOCAL) //kludge: just use local heap; allows back-emulation with malloc/free
     {
         void* memptr = malloc(size + extralen);
         if (!memptr) err_ret(nullptr); //errno probably already set by malloc(); //throw std::runtime_error(std::string(strerror(errno)));
-        /*ShmHdr* */ hdrptr = IFHEAPHDR(&hdrs.emplace_back(), static_cast<ShmHdr*>(memptr));
+        /*ShmHdr* */ hdrptr = IFHEAPHDR(new_shmhdr(), static_cast<ShmHdr*>(memptr));
         hdrptr->id = 0;
         hdrptr->key = key;
         hdrptr->size = size; //- IFHEAPHDR(0, sizeof(ShmHdr));
         hdrptr->usrptr = IFHEAPHDR(memptr, hdrptr + 1);
+        hdrptr->maplen = 0;
+        hdrptr->opts = SHM_SYSV;
         hdrptr->marker = ShmHdr::SHM_VALID ^ (false? 1: 0);
         debug(SHM_LEVEL, CYAN_MSG << /*timestamp() <<*/ "shmalloc: get LOCAL size " << commas(size + extralen) << " (hdr " << extralen << ") => " << FMT(" addr %p") << hdrptr->usrptr << " (hdr " << hdrptr << ")" << ATLINE(srcline));
     }
@@ -235,12 +267,14 @@ void* shmalloc(size_t size, key_t key = 0, /*bool* existed = 0,*/ SrcLine srclin
         if (size + extralen > shminfo.shm_segsz) err_ret(nullptr, EOVERFLOW); //throw "pre-existing shm smaller than requested"; //TODO: enlarge?
         void* shmptr = shmat(shmid, NULL /*system choses adrs*/, 0); //read/write access
         if (!shmptr || (shmptr == (void*)-1)) err_ret(nullptr); //errno probably already set by shmat(); //throw std::runtime_error(std::string(strerror(errno)));
-        /*ShmHdr* */ hdrptr = IFHEAPHDR(&hdrs.emplace_back(), static_cast<ShmHdr*>(shmptr));
+        /*ShmHdr* */ hdrptr = IFHEAPHDR(new_shmhdr(), static_cast<ShmHdr*>(shmptr));
 //printf("here4 %p\n", ptr); fflush(stdout);
         hdrptr->id = shmid;
         hdrptr->key = key;
         hdrptr->size = shminfo.shm_segsz - extralen; //- sizeof(ShmHdr);
         hdrptr->usrptr = IFHEAPHDR(shmptr, hdrptr + 1); //read/write access
+        hdrptr->maplen = 0;
+        hdrptr->opts = SHM_SYSV;
         hdrptr->marker = ShmHdr::SHM_VALID ^ (existed? 1: 0);
         debug(SHM_LEVEL, CYAN_MSG << /*timestamp() <<*/ "shmalloc: cre shmget key " << FMT("0x%lx") << key << ", size " << commas(size + extralen) << " (" << commas(shminfo.shm_segsz) << " padded, hdr " << extralen << "), existed? " << existed << ", #att " <<  shminfo.shm_nattch << " => " << FMT("id 0x%lx") << shmid << FMT(", addr %p") << hdrptr->usrptr << ATLINE(srcline));
     }
@@ -250,6 +284,75 @@ void* shmalloc(size_t size, key_t key = 0, /*bool* existed = 0,*/ SrcLine srclin
 }
 
 
+//Posix shm backend:
+//attach count is kept in a trailer at the end of the mapping so caller's data starts at offset 0, same as SysV (external readers can still use the manifest offsets)
+//CAUTION: count is not decremented if a proc crashes; stale segs can be removed from /dev/shm or /dev/hugepages
+struct ShmTrailer
+{
+    std::atomic<int32_t> nattch;
+    uint32_t marker;
+};
+inline ShmTrailer* shmtrailer(const ShmHdr* hdrptr) { return reinterpret_cast<ShmTrailer*>(static_cast<uint8_t*>(hdrptr->usrptr) - IFHEAPHDR(0, sizeof(ShmHdr)) + hdrptr->maplen) - 1; }
+
+//shm name derived from key so other procs can find it:
+const char* shmname(char* buf, size_t buflen, key_t key, bool huge)
+{
+    snprintf(buf, buflen, huge? "/dev/hugepages/shmalloc-%08x": "/shmalloc-%08x", key);
+    return buf;
+}
+
+void* shmalloc_posix(size_t size, key_t key, SrcLine srcline /*= 0*/)
+{
+    static const size_t PAGELEN = sysconf(_SC_PAGESIZE), HUGELEN = 2 << 20; //2 MB huge pages on ARM and Intel
+    char name[48];
+    int opts = shm_opts, fd = -1;
+    bool existed = false;
+    struct stat st;
+//try hugetlbfs first; needs pages reserved ahead of time (echo N > /proc/sys/vm/nr_hugepages) and hugetlbfs mounted at /dev/hugepages:
+    if (opts & SHM_HUGEPAGE)
+    {
+        shmname(name, sizeof(name), key, true);
+        if ((fd = open(name, O_RDWR | O_CREAT | O_EXCL, 0666)) == -1) existed = ((fd = open(name, O_RDWR, 0666)) != -1);
+        if (fd != -1) opts |= SHM_HUGETLBFS; //remember which name was used
+    }
+    if (fd == -1) //regular tmpfs shm; transparent huge pages (advisory) are used instead of hugetlbfs
+    {
+        shmname(name, sizeof(name), key, false);
+        if ((fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0666)) == -1) existed = ((fd = shm_open(name, O_RDWR, 0666)) != -1);
+    }
+    if (fd == -1) err_ret(nullptr); //errno already set by open()
+    size_t maplen = (opts & SHM_HUGETLBFS)? rndup(size + sizeof(ShmTrailer), HUGELEN): rndup(size + sizeof(ShmTrailer), PAGELEN);
+    if (existed && (fstat(fd, &st) == -1)) { int sv_errno = errno; close(fd); err_ret(nullptr, sv_errno); }
+    if (existed && (st.st_size < size + sizeof(ShmTrailer))) { close(fd); err_ret(nullptr, st.st_size? EOVERFLOW: EAGAIN); } //pre-existing smaller than requested (or creator hasn't sized it yet)
+    if (existed) maplen = st.st_size; //trailer location must match other procs
+    else if (ftruncate(fd, maplen) == -1) { int sv_errno = errno; close(fd); err_ret(nullptr, sv_errno); }
+    void* shmptr = mmap(NULL /*system choses adrs*/, maplen, PROT_READ | PROT_WRITE, MAP_SHARED | ((opts & SHM_HUGETLBFS)? MAP_HUGETLB: 0) | ((opts & SHM_PREFAULT)? MAP_POPULATE: 0), fd, 0);
+    close(fd); //mapping stays valid after close
+    if (shmptr == MAP_FAILED) err_ret(nullptr); //errno already set by mmap()
+    if ((opts & SHM_HUGEPAGE) && !(opts & SHM_HUGETLBFS) && madvise(shmptr, maplen, MADV_HUGEPAGE)) opts &= ~SHM_HUGEPAGE; //THP not available; not fatal
+    if ((opts & SHM_MLOCK) && mlock(shmptr, maplen)) { debug(SHM_LEVEL, YELLOW_MSG "shmalloc: can't mlock %s bytes: %s (check ulimit -l)", commas(maplen), strerror(errno)); opts &= ~SHM_MLOCK; } //not fatal
+//touch each page so first access during playback doesn't page fault:
+//atomic add 0 forces write fault without changing contents (other procs might already be using it)
+    if (opts & SHM_PREFAULT)
+        for (size_t ofs = 0; ofs < maplen; ofs += PAGELEN)
+            reinterpret_cast<std::atomic<uint32_t>*>(static_cast<uint8_t*>(shmptr) + ofs)->fetch_add(0);
+    ShmHdr* hdrptr = IFHEAPHDR(new_shmhdr(), static_cast<ShmHdr*>(shmptr));
+    hdrptr->id = -1; //fd not needed after mmap
+    hdrptr->key = key;
+    hdrptr->size = maplen - sizeof(ShmTrailer) - IFHEAPHDR(0, sizeof(ShmHdr));
+    hdrptr->usrptr = IFHEAPHDR(shmptr, hdrptr + 1);
+    hdrptr->maplen = maplen;
+    hdrptr->opts = opts | SHM_POSIX;
+    hdrptr->numents = 0; //no type info; added by type-safe wrappers
+    hdrptr->marker = ShmHdr::SHM_VALID ^ (existed? 1: 0);
+    ShmTrailer* tlrptr = shmtrailer(hdrptr);
+    if (!existed) tlrptr->marker = ShmHdr::SHM_VALID;
+    int nattch = ++tlrptr->nattch;
+    debug(SHM_LEVEL, CYAN_MSG << "shmalloc: posix " << name << ", size " << commas(size) << " (" << commas(maplen) << " mapped), existed? " << existed << ", #att " << nattch << ", opts 0x" << std::hex << hdrptr->opts << " (wanted 0x" << shm_opts << ")" << std::dec << FMT(", addr %p") << hdrptr->usrptr << ATLINE(srcline));
+    err_ret(hdrptr->usrptr, 0);
+}
+
+
 #if 0 //not needed?
 void* shmreattch(size_t size, key_t key = 0, /*bool* existed = 0,*/ SrcLine srcline = 0)
 {
@@ -289,6 +392,7 @@ int shmnattch(const void* addr, SrcLine srcline = 0)
 {
     struct shmid_ds shminfo;
     if (get_shmhdr(addr, srcline)->key == ShmHdr::SHM_LOCAL) return 1; //TODO: count threads?
+    if (get_shmhdr(addr, srcline)->opts & SHM_POSIX) return shmtrailer(get_shmhdr(addr, srcline))->nattch.load(); //no O/S attach count for Posix shm
     return (shmctl(get_shmhdr(addr, srcline)->id, IPC_STAT, &shminfo) != -1)? shminfo.shm_nattch: 0; //always ask O/S because might have changed > create/attach
 }
 
@@ -317,6 +421,14 @@ int shmfree(const void* addr, SrcLine srcline = 0) //CAUTION: data members not v
         free(IFHEAPHDR(svhdr.usrptr, /*svhdr.usrptr - 1*/ hdrptr)); //(void*)ptr);
         shminfo.shm_nattch = 0;
     }
+    else if (svhdr.opts & SHM_POSIX)
+    {
+        char name[48];
+        shminfo.shm_nattch = --shmtrailer(&svhdr)->nattch;
+        if (munmap(IFHEAPHDR(svhdr.usrptr, hdrptr), svhdr.maplen) == -1) throw std::runtime_error(strerror(errno)); //also unlocks
+        if (!shminfo.shm_nattch) //no more procs attached, delete memory
+            if ((svhdr.opts & SHM_HUGETLBFS)? unlink(shmname(name, sizeof(name), svhdr.key, true)): shm_unlink(shmname(name, sizeof(name), svhdr.key, false))) throw std::runtime_error(strerror(errno));
+    }
     else
     {
         if (shmdt(IFHEAPHDR(svhdr.usrptr, hdrptr)) == -1) throw std::runtime_error(strerror(errno));
@@ -328,7 +440,7 @@ int shmfree(const void* addr, SrcLine srcline = 0) //CAUTION: data members not v
 //        debug(CYAN_MSG << timestamp() << "shmfree: freed " << svhdr.id << FMT("0x%lx") << svhdr.key << ", size " << shminfo.shm_segsz << ENDCOLOR_ATLINE(srcline));
 //    }
     }
-    IFHEAPHDR(hdrs.erase(hdrptr - &hdrs[0] + hdrs.begin()), 0); //static_cast<ShmHdr*>(memptr));
+    IFHEAPHDR(del_shmhdr(hdrptr), 0); //static_cast<ShmHdr*>(memptr));
     debug(SHM_LEVEL, CYAN_MSG << /*timestamp() <<*/ "shmfree: ptr " << addr << FMT(", key 0x%lx") << svhdr.key << ", size " << commas(svhdr.size) << ", #attch " << shminfo.shm_nattch << ATLINE(srcline));
     err_ret(shminfo.shm_nattch, 0); //return #procs still using memory
 }
@@ -928,6 +1040,17 @@ void unit_test(ARGS& args)
     INSPECT("ptr " << ptr << ", *ptr " << std::hex << ptr[0] << std::dec);
     shmfree(ptr);
 
+//Posix backend; huge pages/mlock are best-effort and will be dropped from opts if not available:
+    shm_opts = SHM_POSIX | SHM_HUGEPAGE | SHM_MLOCK | SHM_PREFAULT;
+    uint32_t* pxptr = static_cast<uint32_t*>(shmalloc(4 * sizeof(uint32_t), 0xbeef1234, SRCLINE));
+    uint32_t* pxptr2 = static_cast<uint32_t*>(shmalloc(4 * sizeof(uint32_t), 0xbeef1234, SRCLINE)); //2nd attach, same proc
+    pxptr[0] = 0x12345678;
+    INSPECT("posix ptr " << pxptr << ", *ptr2 " << std::hex << pxptr2[0] << std::dec << ", #attch " << shmnattch(pxptr) << ", existed? " << shmexisted(pxptr2) << ", opts 0x" << std::hex << get_shmhdr(pxptr)->opts << std::dec);
+    shmfree(pxptr2);
+    INSPECT("#attch after free " << shmnattch(pxptr));
+    shmfree(pxptr);
+    shm_opts = SHM_SYSV;
+
     AutoShmary<TestClass, 5> ary1(KEY, SRCLINE);
     INSPECT(ary1 << ", &end " << &ary1[5]);
 
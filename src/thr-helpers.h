@@ -11,6 +11,15 @@
 #include <mutex> //std:mutex<>, std::unique_lock<>
 #include <vector>
 #include <bitset>
+#include <atomic> //std::atomic<>
+#include <algorithm> //std::max()
+#include <functional> //std::function<>
+#include <climits> //INT_MAX
+#include <cerrno> //errno, ETIMEDOUT
+#include <time.h> //clock_gettime()
+#include <unistd.h> //syscall()
+#include <sys/syscall.h> //SYS_futex
+#include <linux/futex.h> //FUTEX_WAIT_BITSET, FUTEX_WAKE
 
 //#include "srcline.h"
 //#include "msgcolors.h"
@@ -87,20 +96,24 @@ public:
 
 //sync with bkg thread:
 //NOTE: std::mutex, std::condition_variable in shm *cannot* be used across processes (read that Posix ipc not implemented in stl)
-template <typename VALTYPE = uint32_t, bool WANT_DEBUG = false>
+//uses futex instead: lock-free when no-one is waiting, and works in shm (IPC = true) or just within one process (IPC = false, a little faster)
+//waiters register the value (or bits) they want so setters only make a syscall when it could satisfy a waiter (was 1 lock + notify_all per bit set)
+//CAUTION: m_val must stay the first member; shm header views (ready_inx) address it directly
+template <typename VALTYPE = uint32_t, bool WANT_DEBUG = false, bool IPC = true>
 class BkgSync
 {
     static const int SYNC_LEVEL = 55;
 #define DEBUG(desc, srcline)  debug(SYNC_LEVEL, GREEN_MSG << desc << /*ENDCOLOR_*/ ATLINE(srcline))
-    std::atomic<VALTYPE> m_val; //avoid mutex locks except when waiting; //= 0; //init to !busy
-    std::mutex m_mtx;
-//    std::atomic<std::condition_variable> m_cv; //avoid mutex locks except when waiting
-    std::condition_variable m_cv;
-    using LOCKTYPE = std::unique_lock<decltype(m_mtx)>; //not: std::lock_guard<decltype(m_mtx)>;
+    static_assert(sizeof(VALTYPE) == sizeof(int), "futex needs 32-bit value");
+    static const VALTYPE ANY_VAL = ~(VALTYPE)0 >> 1, NO_WAITER = ~ANY_VAL; //special values for m_want; CAUTION: can't wait for these values selectively (they still work, just wake more often)
+    static const int FUTEX_FLAGS = IPC? 0: FUTEX_PRIVATE_FLAG;
+    std::atomic<VALTYPE> m_val; //futex word; //= 0; //init to !busy
+    std::atomic<VALTYPE> m_want; //value or bits wanted by waiter(s); ANY_VAL if they want different ones
+    std::atomic<int32_t> m_numwait; //#threads/procs waiting; setter skips wakeup syscall if 0
 public: //ctors/dtors
-    explicit inline BkgSync(VALTYPE init = 0): m_val(init) {}
+    explicit inline BkgSync(VALTYPE init = 0): m_val(init), m_want(NO_WAITER), m_numwait(0) {}
 public: //operators
-    inline operator VALTYPE() { return m_val.load(); }
+    inline operator VALTYPE() const { return m_val.load(); }
     inline VALTYPE operator=(VALTYPE newval) { store(newval); return m_val.load(); } //m_val = newval; //m_cv.notify_all();
     inline VALTYPE operator|=(VALTYPE moreval) { fetch_or(moreval); return m_val.load(); } //m_val |= moreval; //m_cv.notify_all();
 public: //operators
@@ -109,6 +122,8 @@ public: //operators
         ostrm << "{" << commas(sizeof(that)) << ": @" << &that;
         if (!&that) { ostrm << " (NO DATA)"; return ostrm; }
         ostrm << ", val " << sizeof(that.m_val) << ": 0x" << std::hex << that.load() << std::dec;
+        ostrm << ", #wait " << that.m_numwait.load();
+        if (that.m_numwait.load()) ostrm << " for 0x" << std::hex << that.m_want.load() << std::dec;
         ostrm << "}";
         return ostrm;
     }
@@ -120,42 +135,82 @@ public: //methods
     inline void store(VALTYPE newval, SrcLine srcline = 0)
     {
         if (WANT_DEBUG) DEBUG("BkgSync = 0x" << std::hex << newval << std::dec, srcline);
-        LOCKTYPE lock(m_mtx); //NOTE: mutex must be held while var is changed even if atomic, according to https://en.cppreference.com/w/cpp/thread/condition_variable
-//        want_or? m_val |= newval: m_val = newval;
         VOID m_val.store(newval);
-        VOID notify(srcline);
+        VOID notify(newval, srcline);
     }
     inline auto fetch_or(VALTYPE bits, SrcLine srcline = 0)
     {
         if (WANT_DEBUG) DEBUG("BkgSync |= 0x" << std::hex << bits << std::dec, srcline);
-        LOCKTYPE lock(m_mtx); //NOTE: mutex must be held while var is changed even if atomic, according to https://en.cppreference.com/w/cpp/thread/condition_variable
         VALTYPE oldval = m_val.fetch_or(bits);
-        VOID notify(srcline);
+        if ((oldval | bits) != oldval) VOID notify(oldval | bits, srcline); //no change = no wakeup
         return oldval; //give *old* value to caller
     }
-    void notify(SrcLine srcline = 0)
+//wake waiters only if new value could satisfy one of them:
+//NOTE: "has all wanted bits" covers both wait() (exact value) and wait_all() (bits); exact waiters just re-check and sleep again
+    void notify(VALTYPE newval, SrcLine srcline = 0)
     {
-        if (WANT_DEBUG) DEBUG("BkgSync notify all, val " << load(), srcline);
-////        all? m_cv.notify_all(): m_cv.notify_one();
-//        m_cv.notify_all();
-        VOID m_cv.notify_all();
+        if (!m_numwait.load()) return; //fast path: no-one waiting
+        VALTYPE want = m_want.load();
+        if ((want != ANY_VAL) && (want != NO_WAITER) && ((newval & want) != want)) return; //not what waiter wants
+        if (WANT_DEBUG) DEBUG("BkgSync wake all, val 0x" << std::hex << newval << std::dec, srcline);
+        VOID futex(FUTEX_WAKE, INT_MAX);
     }
+    void notify(SrcLine srcline = 0) { notify(ANY_VAL, srcline); } //unconditional
     typedef std::function<bool(void)> CANCEL; //void* (*REFILL)(mySDL_AutoTexture* txtr); //void);
+//wait for exact value:
     bool wait(VALTYPE want_value = 0, CANCEL cancel = NULL, bool blocking = true, SrcLine srcline = 0)
     {
-        if (WANT_DEBUG) DebugInOut(YELLOW_MSG "BkgSync wait for 0x" << std::hex << want_value << std::dec << " (" << &"non-blocking"[blocking? 4: 0] << "): thr# " << Thrinx() << ", cur val 0x" << std::hex << load() << " or 0x" << m_val << std::dec << ", match? " << (load() == want_value) << ATLINE(srcline));
+        static const int CANCEL_POLL_MSEC = 50; //cancel() is checked at least this often
+        if (WANT_DEBUG) DebugInOut(YELLOW_MSG "BkgSync wait for 0x" << std::hex << want_value << std::dec << " (" << &"non-blocking"[blocking? 4: 0] << "): thr# " << Thrinx() << ", cur val 0x" << std::hex << load() << std::dec << ", match? " << (load() == want_value) << ATLINE(srcline));
         if (load() == want_value) return true; //no need to wait, already has desired value
-        if (blocking)
+        if (!blocking) return false;
+        VOID wait_until([want_value](VALTYPE curval) { return curval == want_value; }, want_value, cancel? CANCEL_POLL_MSEC: -1, cancel, srcline);
+        return true;
+    }
+//wait for all of want_bits to be set (other bits ignored), up to timeout_msec:
+//returns false on timeout; setters that don't wake (JS Atomics.or on a shm word) are only seen at timeout
+    bool wait_all(VALTYPE want_bits, int timeout_msec, SrcLine srcline = 0)
+    {
+        if ((load() & want_bits) == want_bits) return true;
+        return wait_until([want_bits](VALTYPE curval) { return (curval & want_bits) == want_bits; }, want_bits, std::max(timeout_msec, 0), NULL, srcline);
+    }
+private: //helpers
+//register before checking value again so setter can't miss us:
+//timeout_msec < 0 waits forever; with cancel(), timeout is a poll interval, else it ends the wait
+    template <typename PRED>
+    bool wait_until(PRED&& satisfied, VALTYPE want_value, int timeout_msec, CANCEL cancel, SrcLine srcline = 0)
+    {
+        struct timespec deadline; //absolute (FUTEX_WAIT_BITSET), so wakeups that don't satisfy us don't extend the wait
+        auto arm = [&deadline, timeout_msec]()
         {
-            if (WANT_DEBUG) DEBUG("BkgSync lock and wait", srcline);
-            LOCKTYPE lock(m_mtx);
-            m_cv.wait(lock, [this, want_value, cancel]
+            VOID clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_sec += timeout_msec / 1000;
+            deadline.tv_nsec += (timeout_msec % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) { ++deadline.tv_sec; deadline.tv_nsec -= 1000000000L; }
+        };
+        if (timeout_msec >= 0) arm();
+        bool retval;
+        ++m_numwait;
+        VALTYPE want = NO_WAITER;
+        while (!m_want.compare_exchange_weak(want, ((want == NO_WAITER) || (want == want_value))? want_value: ANY_VAL)); //multiple waiters want different values
+        for (;;)
+        {
+            VALTYPE curval = load();
+            if ((retval = satisfied(curval))) break;
+            if (cancel && cancel()) break;
+            if (WANT_DEBUG) DEBUG("BkgSync futex wait, val 0x" << std::hex << curval << std::dec, srcline);
+            if ((futex(FUTEX_WAIT_BITSET, curval, (timeout_msec >= 0)? &deadline: NULL) == -1) && (errno == ETIMEDOUT)) //returns immediately if value already changed; spurious wakeups filtered above
             {
-                if (cancel && cancel()) return true;
-                return load() == want_value; //filter out spurious wakeups
-            });
+                if (!cancel) { retval = satisfied(load()); break; }
+                arm(); //poll cancel() again
+            }
         }
-        return blocking;
+        if (!--m_numwait) { want = m_want.load(); VOID m_want.compare_exchange_strong(want, NO_WAITER); } //last waiter; CAUTION: might race with new waiter, but that only causes extra wakeups
+        return retval;
+    }
+    inline int futex(int op, VALTYPE val, const struct timespec* timeout = NULL)
+    {
+        return syscall(SYS_futex, reinterpret_cast<int*>(&m_val), op | FUTEX_FLAGS, val, timeout, NULL, FUTEX_BITSET_MATCH_ANY); //CAUTION: assumes std::atomic<> is just the value
     }
 #undef DEBUG
 };
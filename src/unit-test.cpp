@@ -17,7 +17,7 @@ echo -e "${PINK}Unit testing '${TOTEST}' on ${HOSTOS} ...${ENDCOLOR}"
 OPT=3  #3 = max; 0 = none
 #CFLAGS="-fPIC -pthread -Wall -Wextra -Wno-unused-parameter -m64 -O$OPT -fno-omit-frame-pointer -fno-rtti -fexceptions  -w -Wall -pedantic -Wvariadic-macros -g -std=c++14"
 CFLAGS="`sdl2-config --cflags` -I. -fPIC -pthread -Wall -Wextra -Wno-unused-parameter -O$OPT -fno-omit-frame-pointer -frtti -fexceptions  -w -Wall -pedantic -Wvariadic-macros -g -std=c++14 -x c++" #-fno-rtti
-CLIBS="`sdl2-config --libs`" #-lGL
+CLIBS="`sdl2-config --libs` -lrt" #-lGL; -lrt for shm_open()
 if [ -f "/boot/config.txt" ]; then #RPi
     CFLAGS="${CFLAGS} -DRPI_NO_X #-j4"
 else
@@ -0,0 +1,84 @@
+//Writable stream interface to a GPU port:
+//each frame (or univ slice) written to the stream is copied into the next frame buffer slot (nodebufs[]);
+//write() returns false while the previous frame is still waiting for a free slot, so piping applies backpressure naturally
+
+//usage:
+//  const {createWriteStream} = require("gpuport/stream");
+//  fs.createReadStream("show.seq").pipe(createWriteStream({univ: 0, numuniv: 24}));
+//frames are ARGB Uint32 values (host byte order), numuniv x univlen nodes each; any chunk size is ok (frames are reassembled)
+
+"use strict";
+const {Writable} = require("stream"); //https://nodejs.org/api/stream.html#stream_class_stream_writable
+const gp = require("./build/Release/gpuport");
+
+
+class GpuPortStream extends Writable
+{
+//opts: port (default gp = port 0), univ (first univ, default 0), numuniv (default all remaining), univlen (default UNIV_LEN), frnum (first fr#, default numfr)
+    constructor(opts)
+    {
+        opts = opts || {};
+        const port = opts.port || gp;
+        const univ = opts.univ || 0;
+        const numuniv = opts.numuniv || (port.NUM_UNIV - univ);
+        const univlen = opts.univlen || port.UNIV_LEN;
+        const framelen = numuniv * univlen * Uint32Array.BYTES_PER_ELEMENT; //bytes
+        if (!(framelen > 0)) throw new Error(`bad frame size: ${numuniv} univ x ${univlen} nodes (open port first or pass univlen)`);
+        super({highWaterMark: framelen + 1, decodeStrings: true}); //+1 so write() only returns false if a frame is already waiting
+        Object.assign(this, {port, univ, numuniv, univlen, framelen});
+        this.frnum = (opts.frnum !== undefined)? opts.frnum: port.numfr; //next fr# to write
+        this.frame = Buffer.alloc(framelen); //reassemble frames here; Buffer.alloc is not pooled, so it's 4-byte aligned
+        this.fill = 0; //#bytes in frame so far
+        this.numwritten = this.numdropped = 0; //stats
+    }
+    _write(chunk, encoding, cb)
+    {
+        let ofs = 0;
+        const next = (err) =>
+        {
+            if (err) return cb(err);
+            while (ofs < chunk.length)
+            {
+                const len = Math.min(chunk.length - ofs, this.framelen - this.fill);
+                chunk.copy(this.frame, this.fill, ofs, ofs + len);
+                this.fill += len;
+                ofs += len;
+                if (this.fill < this.framelen) break; //need more data
+                this.fill = 0;
+                if (!this.commit(next)) return; //wait for free slot
+            }
+            cb();
+        };
+        next();
+    }
+    _final(cb)
+    {
+        if (!this.fill) return cb();
+        this.frame.fill(0, this.fill); //partial last frame: pad with black (alpha 0 is ignored)
+        this.fill = 0;
+        if (this.commit(cb)) cb();
+    }
+//copy frame into its slot; returns false if it needs to wait (calls cb when done)
+    commit(cb)
+    {
+        const colors = new Uint32Array(this.frame.buffer, this.frame.byteOffset, this.framelen / Uint32Array.BYTES_PER_ELEMENT);
+        for (;;)
+        {
+            const status = this.port.writeFrame(this.frnum, colors, this.univ, this.univlen);
+            if (status < 0) { ++this.numdropped; this.frnum = Math.max(this.frnum + 1, this.port.numfr); continue; } //gpu wker already passed this fr#; skip ahead
+            if (!status) break; //slot still holds an earlier frame
+            ++this.frnum;
+            ++this.numwritten;
+            return true;
+        }
+//wait until gpu wker recycles the slot for this fr#:
+        this.port.nextFrame(this.frnum - this.port.nodebufs.length).then(() => this.commit(cb) && cb(), cb);
+        return false;
+    }
+}
+
+
+function createWriteStream(opts) { return new GpuPortStream(opts); }
+
+module.exports = {GpuPortStream, createWriteStream};
+//eof